@@ -63,7 +63,7 @@ Application::Application(char *infile) {
 		Address joinaddr;
 		joinaddr = getjoinaddr();
 		addressOfMemberNode = (Address *) en->ENinit(addressOfMemberNode, par->PORTNUM);
-		mp1[i] = new MP1Node(memberNode, par, en, log, addressOfMemberNode);
+		mp1[i] = MP1Node::create(memberNode, par, en, log, addressOfMemberNode);
 		log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
 		delete addressOfMemberNode;
 	}
@@ -183,9 +183,18 @@ void Application::fail() {
 
 	if( par->SINGLE_FAILURE && par->getcurrtime() == 100 ) {
 		removed = (rand() % par->EN_GPSZ);
-		#ifdef DEBUGLOG
-		log->LOG(&mp1[removed]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-		#endif
+		if( par->GRACEFUL_LEAVE ) {
+			// the node announces it is going instead of crashing
+			#ifdef DEBUGLOG
+			log->LOG(&mp1[removed]->getMemberNode()->addr, "Node left at time=%d", par->getcurrtime());
+			#endif
+			mp1[removed]->leaveGroup();
+		}
+		else {
+			#ifdef DEBUGLOG
+			log->LOG(&mp1[removed]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
+			#endif
+		}
 		mp1[removed]->getMemberNode()->bFailed = true;
 	}
 	else if( par->getcurrtime() == 100 ) {
@@ -12,17 +12,20 @@
 EmulNet::EmulNet(Params *p)
 {
 	//trace.funcEntry("EmulNet::EmulNet");
-	int i,j;
 	par = p;
 	emulnet.setNextId(1);
 	emulnet.settCurrBuffSize(0);
+	emulnet.inbox.resize(par->EN_GPSZ + 1);
 	enInited=0;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			sent_msgs[i][j] = 0;
-			recv_msgs[i][j] = 0;
-		}
-	}
+	// counters are kept per node id, ids start at 1
+	sent_msgs.resize(par->EN_GPSZ + 1);
+	recv_msgs.resize(par->EN_GPSZ + 1);
+	sent_bytes.assign(par->EN_GPSZ + 1, 0);
+	cross_msgs.assign(par->EN_GPSZ + 1, 0);
+	cross_bytes.assign(par->EN_GPSZ + 1, 0);
+	lastPayload = NULL;
+	lastSrc = 0;
+	lastTime = -1;
 	//trace.funcExit("EmulNet::EmulNet", SUCCESS);
 }
 
@@ -30,15 +33,16 @@ EmulNet::EmulNet(Params *p)
  * Copy constructor
  */
 EmulNet::EmulNet(EmulNet &anotherEmulNet) {
-	int i, j;
 	this->par = anotherEmulNet.par;
 	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
-	}
+	this->sent_msgs = anotherEmulNet.sent_msgs;
+	this->recv_msgs = anotherEmulNet.recv_msgs;
+	this->sent_bytes = anotherEmulNet.sent_bytes;
+	this->cross_msgs = anotherEmulNet.cross_msgs;
+	this->cross_bytes = anotherEmulNet.cross_bytes;
+	this->lastPayload = NULL;
+	this->lastSrc = 0;
+	this->lastTime = -1;
 	this->emulnet = anotherEmulNet.emulnet;
 }
 
@@ -46,15 +50,16 @@ EmulNet::EmulNet(EmulNet &anotherEmulNet) {
  * Assignment operator overloading
  */
 EmulNet& EmulNet::operator =(EmulNet &anotherEmulNet) {
-	int i, j;
 	this->par = anotherEmulNet.par;
 	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
-	}
+	this->sent_msgs = anotherEmulNet.sent_msgs;
+	this->recv_msgs = anotherEmulNet.recv_msgs;
+	this->sent_bytes = anotherEmulNet.sent_bytes;
+	this->cross_msgs = anotherEmulNet.cross_msgs;
+	this->cross_bytes = anotherEmulNet.cross_bytes;
+	this->lastPayload = NULL;
+	this->lastSrc = 0;
+	this->lastTime = -1;
 	this->emulnet = anotherEmulNet.emulnet;
 	return *this;
 }
@@ -85,31 +90,52 @@ void *EmulNet::ENinit(Address *myaddr, short port) {
  * size
  */
 int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
-	en_msg *em;
+	en_msg em;
 	static char temp[2048];
 	int sendmsg = rand() % 100;
+	int capacity = max(ENBUFFSIZE, ENBUFFPERNODE * par->EN_GPSZ);
+	int dst = *(int *)(toaddr->addr);
 
-	if( (emulnet.currbuffsize >= ENBUFFSIZE) || (size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE) || (par->dropmsg && sendmsg < (int) (par->MSG_DROP_PROB * 100)) ) {
+	if( (emulnet.currbuffsize >= capacity) || (size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE) || (par->dropmsg && sendmsg < (int) (par->MSG_DROP_PROB * 100)) || dst < 1 || dst > par->EN_GPSZ ) {
 //        cout<<"message lost"<<endl;
 		return 0;
 	}
 
-	em = (en_msg *)malloc(sizeof(en_msg) + size);
-	em->size = size;
-
-	memcpy(&(em->from.addr), &(myaddr->addr), sizeof(em->from.addr));
-	memcpy(&(em->to.addr), &(toaddr->addr), sizeof(em->from.addr));
-	memcpy(em + 1, data, size);
-
-	emulnet.buff[emulnet.currbuffsize++] = em;
-
 	int src = *(int *)(myaddr->addr);
 	int time = par->getcurrtime();
 
-	assert(src <= MAX_NODES);
+	assert(src <= par->EN_GPSZ);
 	assert(time < MAX_TIME);
 
-	sent_msgs[src][time]++;
+	// the copies of one gossip round share their payload instead of each holding the member list
+	if ( lastPayload == NULL || lastSrc != src || lastTime != time || lastPayload->size != size || memcmp(lastPayload + 1, data, size) != 0 ) {
+		releasePayload(lastPayload);
+		lastPayload = (en_payload *)malloc(sizeof(en_payload) + size);
+		lastPayload->refs = 1;
+		lastPayload->size = size;
+		memcpy(lastPayload + 1, data, size);
+		lastSrc = src;
+		lastTime = time;
+	}
+	lastPayload->refs++;
+
+	em.size = size;
+	em.payload = lastPayload;
+	memcpy(&(em.from.addr), &(myaddr->addr), sizeof(em.from.addr));
+	memcpy(&(em.to.addr), &(toaddr->addr), sizeof(em.from.addr));
+	// a message between zones pays the cross-zone delay on top of the usual tick
+	bool crossZone = par->zoneOf(src) != par->zoneOf(dst);
+	em.deliverAt = time + (crossZone ? par->CROSS_ZONE_DELAY : 0);
+
+	emulnet.inbox[dst].push_back(em);
+	emulnet.currbuffsize++;
+
+	countAt(sent_msgs[src], time);
+	sent_bytes[src] += size;
+	if (crossZone) {
+		cross_msgs[src]++;
+		cross_bytes[src] += size;
+	}
 
 	#ifdef DEBUGLOG
 //		cout<<"Sending 4+"<<size-4<<" B msg type "<<*(int *)data<<" from "<<(int)myaddr->addr[0]<<"."<<(int)myaddr->addr[1]<<"."<<(int)myaddr->addr[2]<<"."<<(int)myaddr->addr[3]<<":"<<*(short *)&myaddr->addr[4]<<" to "<<(int)toaddr->addr[0]<<"."<<(int)toaddr->addr[1]<<"."<<(int)toaddr->addr[2]<<"."<<(int)toaddr->addr[3]<<":"<<*(short *)&toaddr->addr[4]<<endl;
@@ -146,39 +172,65 @@ int EmulNet::ENsend(Address *myaddr, Address *toaddr, string data) {
 int EmulNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue){
 	// times is always assumed to be 1
 	int i;
-	char* tmp;
-	int sz;
-	en_msg *emsg;
-
-	for( i = emulnet.currbuffsize - 1; i >= 0; i-- ) {
-		emsg = emulnet.buff[i];
+	en_msg emsg;
+	int dst = *(int *)(myaddr->addr);
+	int time = par->getcurrtime();
 
-		if ( 0 == strcmp(emsg->to.addr, myaddr->addr) ) {
+	assert(dst <= par->EN_GPSZ);
+	assert(time < MAX_TIME);
 
-			sz = emsg->size;
-			tmp = (char *) malloc(sz * sizeof(char));
-			memcpy(tmp, (char *)(emsg+1), sz);
+	// only this node's own messages are scanned
+	vector<en_msg> &inbox = emulnet.inbox[dst];
+	for( i = (int) inbox.size() - 1; i >= 0; i-- ) {
+		emsg = inbox[i];
 
-			emulnet.buff[i] = emulnet.buff[emulnet.currbuffsize-1];
+		if ( emsg.deliverAt <= time ) {
+			inbox[i] = inbox.back();
+			inbox.pop_back();
 			emulnet.currbuffsize--;
 
-			(*enq)(queue, (char *)tmp, sz);
+			// the receiver borrows the shared payload and hands it back with ENrelease
+			(*enq)(queue, (char *)(emsg.payload + 1), emsg.size);
 
-			// cout<<"enqueue"<<endl;
-
-			free(emsg);
+			countAt(recv_msgs[dst], time);
+		}
+	}
 
-			int dst = *(int *)(myaddr->addr);
-			int time = par->getcurrtime();
+	return 0;
+}
 
-			assert(dst <= MAX_NODES);
-			assert(time < MAX_TIME);
+/**
+ * FUNCTION NAME: ENrelease
+ *
+ * DESCRIPTION: Give back a message handed out by ENrecv. Its bytes may be shared with other
+ * 				receivers of the same send, so they are read-only: a handler that wants to
+ * 				change them works on its own copy.
+ */
+void EmulNet::ENrelease(char *data) {
+	releasePayload((en_payload *) data - 1);
+}
 
-			recv_msgs[dst][time]++;
-		}
+/**
+ * FUNCTION NAME: releasePayload
+ *
+ * DESCRIPTION: Drop one reference to a payload, freeing it with the last one
+ */
+void EmulNet::releasePayload(en_payload *payload) {
+	if ( payload != NULL && --payload->refs == 0 ) {
+		free(payload);
 	}
+}
 
-	return 0;
+/**
+ * FUNCTION NAME: countAt
+ *
+ * DESCRIPTION: Count a message in the per-tick counters of a node
+ */
+void EmulNet::countAt(vector<int> &perTick, int time) {
+	if ( (int) perTick.size() <= time ) {
+		perTick.resize(time + 1, 0);
+	}
+	perTick[time]++;
 }
 
 /**
@@ -193,15 +245,24 @@ int EmulNet::ENcleanup() {
 
 	FILE* file = fopen("msgcount.log", "w+");
 
-	while(emulnet.currbuffsize > 0) {
-		free(emulnet.buff[--emulnet.currbuffsize]);
+	for ( i = 0; i < (int) emulnet.inbox.size(); i++ ) {
+		for ( j = 0; j < (int) emulnet.inbox[i].size(); j++ ) {
+			releasePayload(emulnet.inbox[i][j].payload);
+		}
+		emulnet.inbox[i].clear();
 	}
+	emulnet.currbuffsize = 0;
+	releasePayload(lastPayload);
+	lastPayload = NULL;
 
 	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
 		fprintf(file, "node %3d ", i);
 		sent_total = 0;
 		recv_total = 0;
 
+		// the per-tick counters only reach the last tick the node sent or received in
+		sent_msgs[i].resize(par->getcurrtime(), 0);
+		recv_msgs[i].resize(par->getcurrtime(), 0);
 		for (j = 0; j < par->getcurrtime(); j++) {
 
 			sent_total += sent_msgs[i][j];
@@ -217,7 +278,8 @@ int EmulNet::ENcleanup() {
 			}
 		}
 		fprintf(file, "\n");
-		fprintf(file, "node %3d sent_total %6u  recv_total %6u\n\n", i, sent_total, recv_total);
+		fprintf(file, "node %3d sent_total %6u  recv_total %6u\n", i, sent_total, recv_total);
+		fprintf(file, "node %3d sent_bytes %8ld  cross_zone_msgs %6ld  cross_zone_bytes %8ld\n\n", i, sent_bytes[i], cross_msgs[i], cross_bytes[i]);
 	}
 
 	fclose(file);
@@ -187,4 +187,54 @@ fi
 #	echo "Checking Accuracy..............0/10"
 #fi
 #echo "============================================"
+echo "============================================"
+echo "Graceful Leave Scenario"
+echo "============================"
+if [ $verbose -eq 0 ]; then
+	make clean > /dev/null
+	make > /dev/null
+	./Application testcases/leave.conf > /dev/null
+else
+	make clean
+	make
+	./Application testcases/leave.conf
+fi
+joincount=`grep joined dbg.log | cut -d" " -f2,4-7 | sort -u | wc -l`
+if [ $joincount -eq 100 ]; then
+	grade=`expr $grade + 10`
+	echo "Checking Join..................10/10"
+else
+	joinfrom=`grep joined dbg.log | cut -d" " -f2 | sort -u`
+	cnt=0
+	for i in $joinfrom
+	do
+		jointo=`grep joined dbg.log | grep '^ '$i | cut -d" " -f4-7 | grep -v $i | sort -u | wc -l`
+		if [ $jointo -eq 9 ]; then
+			cnt=`expr $cnt + 1`
+		fi
+	done
+	if [ $cnt -eq 10 ]; then
+		grade=`expr $grade + 10`
+		echo "Checking Join..................10/10"
+	else
+		echo "Checking Join..................0/10"
+	fi
+fi
+# the peers must drop the leaver within TFAIL (5) ticks, well before the TREMOVE (20) timeout
+leftnode=`grep "Node left at time" dbg.log | sort -u | awk '{print $1}'`
+lefttime=`grep "Node left at time" dbg.log | sort -u | cut -d"=" -f2`
+leavecount=`grep removed dbg.log | sort -u | grep $leftnode | awk -v t=$lefttime '$NF <= t + 5' | wc -l`
+if [ $leavecount -ge 9 ]; then
+	grade=`expr $grade + 10`
+	echo "Checking Completeness..........10/10"
+else
+	echo "Checking Completeness..........0/10"
+fi
+accuracycount=`grep removed dbg.log | sort -u | grep -v $leftnode | wc -l`
+if [ $accuracycount -eq 0 ] && [ $leavecount -gt 0 ]; then
+	grade=`expr $grade + 10`
+	echo "Checking Accuracy..............10/10"
+else
+	echo "Checking Accuracy..............0/10"
+fi
 echo Final grade $grade
@@ -14,12 +14,26 @@
 #include "Member.h"
 #include "EmulNet.h"
 #include "Queue.h"
+#include "MembershipCodec.h"
+#include "TimerWheel.h"
+#include "PhiAccrualDetector.h"
+#include "PartialView.h"
+#include "MP1Policies.h"
 
 /**
  * Macros
  */
 #define TREMOVE 20
 #define TFAIL 5
+// ticks a removed member stays tombstoned
+#define TTOMBSTONE TREMOVE
+// bounds on the ticks between two gossip rounds. A lost round plus the next one must
+// still fit in the TFAIL deadline, or quiet members would be suspected.
+#define GOSSIP_MIN_INTERVAL 1
+#define GOSSIP_MAX_INTERVAL (TFAIL / 2)
+// ticks of heartbeat the view digest rounds to. An entry that lags a peer's by a whole epoch
+// makes the digests differ, so it is pulled well before the TFAIL deadline.
+#define DIGEST_EPOCH (TFAIL / 2)
 
 /*
  * Note: You can change/add any functions in MP1Node.{h,cpp}
@@ -31,57 +45,163 @@
 enum MsgTypes{
     JOINREQ,
     JOINREP,
-	HEARTBEAT
+	HEARTBEAT,
+	LEAVE,
+	DIGEST,
+	DIGESTREP,
+	DIGESTPUSH,
+	FORWARDJOIN,
+	NEIGHBOR,
+	DISCONNECT,
+	SHUFFLE,
+	SHUFFLEREPLY
 };
 
 /**
- * STRUCT NAME: MessageHdr
+ * STRUCT NAME: Tombstone
  *
- * DESCRIPTION: Header and content of a message
+ * DESCRIPTION: Last heartbeat of a removed member and the tick its tombstone lapses at
  */
-typedef struct MessageHdr {
-	enum MsgTypes msgType;
-}MessageHdr;
+typedef struct Tombstone {
+	long heartbeat;
+	int expireAt;
+}Tombstone;
 
 /**
  * CLASS NAME: MP1Node
  *
- * DESCRIPTION: Class implementing Membership protocol functionalities for failure detection
+ * DESCRIPTION: Membership protocol run by this node, as seen by the Application.
+ * 				create() picks the MP1NodeT instantiation the config asks for. Only these
+ * 				per-tick entry points are virtual.
  */
 class MP1Node {
-private:
+protected:
+	Member *memberNode;
 	EmulNet *emulNet;
 	Log *log;
 	Params *par;
-	Member *memberNode;
 	char NULLADDR[6];
 
-public:
 	MP1Node(Member *, Params *, EmulNet *, Log *, Address *);
+
+public:
+	static MP1Node *create(Member *, Params *, EmulNet *, Log *, Address *);
 	Member * getMemberNode() {
 		return memberNode;
 	}
-	int recvLoop();
 	static int enqueueWrapper(void *env, char *buff, int size);
+	int isNullAddress(Address *addr);
+	Address getJoinAddress();
+	int introducerFor(int id);
+	void printAddress(Address *addr);
+	static long tombstoneKey(int id, short port);
+	virtual int recvLoop() = 0;
+	virtual void nodeStart(char *servaddrstr, short serverport) = 0;
+	virtual int finishUpThisNode() = 0;
+	virtual void leaveGroup() = 0;
+	virtual void nodeLoop() = 0;
+	virtual ~MP1Node() {}
+};
+
+/**
+ * CLASS NAME: MP1NodeT
+ *
+ * DESCRIPTION: Class implementing Membership protocol functionalities for failure detection.
+ * 				The failure detector, the peer selection and the dissemination are policies
+ * 				from MP1Policies.h, called without any dynamic dispatch.
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+class MP1NodeT : public MP1Node {
+private:
+	// Reused encode buffer for outgoing messages
+	vector<char> sendBuf;
+	// Suspect and removal deadlines of the members
+	TimerWheel expiryWheel;
+	// Expiry timer of each memberList entry, kept at the same position
+	vector<int> memberTimers;
+	// Heartbeat inter-arrival history of each memberList entry, used by the phi-accrual detector
+	vector<ArrivalWindow> memberArrivals;
+	// Positions of the members gossiped this tick
+	vector<int> liveMembers;
+	// Positions of the members this gossip round goes to, and working space of the peer selection
+	vector<int> gossipTargets;
+	vector<int> peerScratch;
+	// Recently removed members, keyed by tombstoneKey(id, port)
+	map<long, Tombstone> tombstones;
+	// Tombstone keys in the order they were laid, all with the same lifetime
+	queue<pair<long, int> > tombstoneExpiry;
+	// Joiners whose JOINREQ arrived this tick, answered together by one JOINREP
+	vector<Address> pendingJoins;
+	// Digest of the live view, per id bucket, the mask of non-empty buckets and the root over all of them
+	unsigned int viewDigest[MP1_DIGEST_BUCKETS];
+	unsigned int viewDigestMask;
+	unsigned int viewRoot;
+	// Tick viewDigest was computed at, -1 once the membership list changed
+	int viewDigestTick;
+	// Passive view of the partial-view mode, memberList is the active view
+	PartialView partialView;
+	// Ticks between gossip rounds, widened while the view is stable
+	int gossipInterval;
+	// Tick of the last gossip round and of the one before it
+	int lastGossip;
+	int previousGossip;
+	// Membership epoch seen at the last gossip round
+	long gossipEpoch;
+	PhiAccrualDetector detector;
+
+public:
+	MP1NodeT(Member *, Params *, EmulNet *, Log *, Address *);
+	int recvLoop();
 	void nodeStart(char *servaddrstr, short serverport);
 	int initThisNode(Address *joinaddr);
 	int introduceSelfToGroup(Address *joinAddress);
 	int finishUpThisNode();
+	void leaveGroup();
 	void nodeLoop();
 	void checkMessages();
 	bool recvCallBack(void *env, char *data, int size);
 	void nodeLoopOps();
-	int isNullAddress(Address *addr);
-	Address getJoinAddress();
 	void initMemberListTable(Member *memberNode);
-	void printAddress(Address *addr);
-	virtual ~MP1Node();
-	bool recvJOINREQ(void *env, char *data, int size);
-	bool recvJOINREP(void *env, char *data, int size);
+	virtual ~MP1NodeT();
+	bool recvJOINREQ(void *env, MembershipHdr *hdr, FrameView *body);
+	bool recvJOINREP(void *env, MembershipHdr *hdr, FrameView *body);
+	void flushJoinReplies();
+	static void updateMemberListWrapper(void *env, int id, short port, long heartbeat);
 	void updateMemberList(int id, short port, long heartbeat);
+	int insertMember(int id, short port, long heartbeat);
+	long suspectDeadline(int pos);
+	static void expireMemberWrapper(void *env, int timer, int pos);
+	void expireMember(int timer, int pos);
+	void removeMember(int pos);
+	void addTombstone(int id, short port, long heartbeat);
+	void expireTombstones();
+	void putMemberEntries(unsigned int buckets);
+	void encodeMemberList(enum MsgTypes msgType);
 	void sendMemberList(enum MsgTypes msgType, Address * address);
 	void sendHeartBeat();
-	bool recvHeartBeat(void *env, char *data, int size);
+	void sendToMember(int pos);
+	bool gossipDue();
+	bool recvHeartBeat(void *env, MembershipHdr *hdr, FrameView *body);
+	void computeViewDigest();
+	void sendDigest();
+	bool recvDIGEST(void *env, MembershipHdr *hdr, FrameView *body);
+	bool recvDIGESTREP(void *env, MembershipHdr *hdr, FrameView *body);
+	bool recvDIGESTPUSH(void *env, MembershipHdr *hdr, FrameView *body);
+	static void collectEntryWrapper(void *env, int id, short port, long heartbeat);
+	void sendViewMessage(enum MsgTypes msgType, int id, short port, unsigned long arg,
+			vector<MemberListEntry> *entries);
+	void addActive(int id, short port, long heartbeat, bool highPriority);
+	void dropActive(int pos);
+	void addPassive(int id, short port, long heartbeat);
+	void fillActiveView();
+	void shuffle();
+	bool recvFORWARDJOIN(void *env, MembershipHdr *hdr, FrameView *body);
+	bool recvNEIGHBOR(void *env, MembershipHdr *hdr, FrameView *body);
+	bool recvDISCONNECT(void *env, MembershipHdr *hdr, FrameView *body);
+	bool recvSHUFFLE(void *env, MembershipHdr *hdr, FrameView *body);
+	bool recvSHUFFLEREPLY(void *env, MembershipHdr *hdr, FrameView *body);
+	void sendLeave();
+	bool recvLEAVE(void *env, MembershipHdr *hdr, FrameView *body);
 };
 
 #endif /* _MP1NODE_H_ */
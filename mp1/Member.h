@@ -8,6 +8,8 @@
 #define MEMBER_H_
 
 #include "stdincludes.h"
+#include "MembershipTable.h"
+#include "MembershipEvents.h"
 
 /**
  * CLASS NAME: q_elt
@@ -105,7 +107,9 @@ public:
 	// counter for ping timeout
 	int timeOutCounter;
 	// Membership table
-	vector<MemberListEntry> memberList;
+	MembershipTable memberList;
+	// Changes of the membership table, for consumers such as the KV store
+	MembershipEventLog memberEvents;
 	// My position in the membership table
 	vector<MemberListEntry>::iterator myPos;
 	// Queue for failure detection messages
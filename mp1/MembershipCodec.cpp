@@ -0,0 +1,297 @@
+/**********************************
+ * FILE NAME: MembershipCodec.cpp
+ *
+ * DESCRIPTION: Definition of the membership wire format
+ **********************************/
+
+#include "MembershipCodec.h"
+
+/**
+ * FUNCTION NAME: putVarint
+ *
+ * DESCRIPTION: Append an unsigned LEB128 varint to the buffer
+ */
+void MembershipCodec::putVarint(vector<char> &buf, unsigned long value) {
+	while (value >= 0x80) {
+		buf.push_back((char) ((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	buf.push_back((char) value);
+}
+
+/**
+ * FUNCTION NAME: getVarint
+ *
+ * DESCRIPTION: Read an unsigned LEB128 varint and advance the cursor
+ *
+ * RETURNS:
+ * false if the varint runs past the end of the buffer
+ */
+bool MembershipCodec::getVarint(const char **cursor, const char *end, unsigned long *value) {
+	unsigned long result = 0;
+	int shift = 0;
+	const char *p = *cursor;
+
+	while (p < end && shift < 64) {
+		unsigned char byte = (unsigned char) *p++;
+		result |= (unsigned long) (byte & 0x7f) << shift;
+		if (!(byte & 0x80)) {
+			*cursor = p;
+			*value = result;
+			return true;
+		}
+		shift += 7;
+	}
+	return false;
+}
+
+/**
+ * FUNCTION NAME: putFixed32
+ *
+ * DESCRIPTION: Append a little-endian 32-bit value, used for hashes that do not shrink as varints
+ */
+void MembershipCodec::putFixed32(vector<char> &buf, unsigned int value) {
+	for (int i = 0; i < 4; i++) {
+		buf.push_back((char) (value >> (8 * i)));
+	}
+}
+
+/**
+ * FUNCTION NAME: getFixed32
+ *
+ * DESCRIPTION: Read a little-endian 32-bit value and advance the cursor
+ *
+ * RETURNS:
+ * false if the value runs past the end of the buffer
+ */
+bool MembershipCodec::getFixed32(const char **cursor, const char *end, unsigned int *value) {
+	const unsigned char *p = (const unsigned char *) *cursor;
+
+	if (end - *cursor < 4) {
+		return false;
+	}
+	*value = p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int) p[3] << 24);
+	*cursor += 4;
+	return true;
+}
+
+/**
+ * FUNCTION NAME: zigzag
+ *
+ * DESCRIPTION: Map a signed value onto an unsigned one so small magnitudes stay small
+ */
+unsigned long MembershipCodec::zigzag(long value) {
+	return ((unsigned long) value << 1) ^ (unsigned long) (value >> 63);
+}
+
+/**
+ * FUNCTION NAME: unzigzag
+ *
+ * DESCRIPTION: Inverse of zigzag
+ */
+long MembershipCodec::unzigzag(unsigned long value) {
+	return (long) (value >> 1) ^ -(long) (value & 1);
+}
+
+/**
+ * FUNCTION NAME: beginMessage
+ *
+ * DESCRIPTION: Reset the buffer and write the message header
+ */
+void MembershipCodec::beginMessage(vector<char> &buf, int msgType, Address *from, long heartbeat) {
+	int id;
+	short port;
+	memcpy(&id, &from->addr[0], sizeof(int));
+	memcpy(&port, &from->addr[4], sizeof(short));
+
+	buf.clear();
+	buf.push_back((char) MP1_WIRE_VERSION);
+	buf.push_back((char) msgType);
+	putVarint(buf, (unsigned int) id);
+	putVarint(buf, zigzag(port));
+	putVarint(buf, (unsigned long) heartbeat);
+}
+
+/**
+ * FUNCTION NAME: putEntry
+ *
+ * DESCRIPTION: Append one membership entry, delta encoded against the previous entry
+ * 				and the heartbeat carried in the header
+ */
+void MembershipCodec::putEntry(vector<char> &buf, long baseHeartbeat, int *prevId, int id, short port, long heartbeat) {
+	putVarint(buf, zigzag((long) id - *prevId));
+	putVarint(buf, zigzag(port));
+	putVarint(buf, zigzag(baseHeartbeat - heartbeat));
+	*prevId = id;
+}
+
+/**
+ * FUNCTION NAME: decodeHeader
+ *
+ * DESCRIPTION: Decode the message header in place. body is set to the entry section of the frame
+ *
+ * RETURNS:
+ * false if the frame is malformed or of another wire version
+ */
+bool MembershipCodec::decodeHeader(FrameView *frame, MembershipHdr *hdr, FrameView *body) {
+	const char *p = frame->data;
+	const char *end = frame->data + frame->size;
+	unsigned long id, port, heartbeat;
+
+	if (frame->size < 2 || (unsigned char) p[0] != MP1_WIRE_VERSION) {
+		return false;
+	}
+	hdr->msgType = (unsigned char) p[1];
+	p += 2;
+	if (!getVarint(&p, end, &id) || !getVarint(&p, end, &port) || !getVarint(&p, end, &heartbeat)) {
+		return false;
+	}
+	hdr->id = (int) id;
+	hdr->port = (short) unzigzag(port);
+	hdr->heartbeat = (long) heartbeat;
+	body->data = p;
+	body->size = (int) (end - p);
+	return true;
+}
+
+/**
+ * FUNCTION NAME: decodeEntries
+ *
+ * DESCRIPTION: Walk the entries of a message in place and hand each one to visit
+ *
+ * RETURNS:
+ * false if the entry section is truncated
+ */
+bool MembershipCodec::decodeEntries(FrameView *body, long baseHeartbeat,
+		void (* visit)(void *, int, short, long), void *env) {
+	const char *p = body->data;
+	const char *end = body->data + body->size;
+	long id = 0;
+	unsigned long idDelta, port, age;
+
+	while (p < end) {
+		if (!getVarint(&p, end, &idDelta) || !getVarint(&p, end, &port) || !getVarint(&p, end, &age)) {
+			return false;
+		}
+		id += unzigzag(idDelta);
+		(*visit)(env, (int) id, (short) unzigzag(port), baseHeartbeat - unzigzag(age));
+	}
+	return true;
+}
+
+/**
+ * FUNCTION NAME: digestBucket
+ *
+ * DESCRIPTION: Digest bucket of a member, from the top bits of a multiplicative hash of its id
+ */
+unsigned int MembershipCodec::digestBucket(int id) {
+	return ((unsigned int) id * 2654435761u) >> (32 - MP1_DIGEST_BITS);
+}
+
+/**
+ * FUNCTION NAME: entryDigest
+ *
+ * DESCRIPTION: 32-bit mix of a member address and the epoch of its heartbeat. Bucket digests
+ * 				XOR these, so they do not depend on the order of the membership list.
+ */
+unsigned int MembershipCodec::entryDigest(int id, short port, long epoch) {
+	unsigned int h = (unsigned int) id ^ ((unsigned int) (unsigned short) port << 16);
+	h ^= (unsigned int) epoch * 0x9e3779b1u;
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+	return h;
+}
+
+/**
+ * FUNCTION NAME: decodeRoot
+ *
+ * DESCRIPTION: Decode the root digest of a digest body
+ *
+ * RETURNS:
+ * false if the digest is truncated
+ */
+bool MembershipCodec::decodeRoot(FrameView *body, unsigned int *root) {
+	const char *p = body->data;
+
+	return getFixed32(&p, body->data + body->size, root);
+}
+
+/**
+ * FUNCTION NAME: putDigest
+ *
+ * DESCRIPTION: Append the digests of the non-empty buckets
+ */
+void MembershipCodec::putDigest(vector<char> &buf, unsigned int mask, const unsigned int *digests) {
+	putVarint(buf, mask);
+	for (int bucket = 0; bucket < MP1_DIGEST_BUCKETS; bucket++) {
+		if (mask & (1u << bucket)) {
+			putFixed32(buf, digests[bucket]);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: decodeDigest
+ *
+ * DESCRIPTION: Decode a bucket digest body. Buckets missing from the mask get a zero digest.
+ *
+ * RETURNS:
+ * false if the digest is truncated
+ */
+bool MembershipCodec::decodeDigest(FrameView *body, unsigned int *mask, unsigned int *digests) {
+	FrameView rest;
+
+	if (!decodeMask(body, mask, &rest)) {
+		return false;
+	}
+	const char *p = rest.data;
+	const char *end = rest.data + rest.size;
+	for (int bucket = 0; bucket < MP1_DIGEST_BUCKETS; bucket++) {
+		digests[bucket] = 0;
+		if ((*mask & (1u << bucket)) && !getFixed32(&p, end, &digests[bucket])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * FUNCTION NAME: decodeMask
+ *
+ * DESCRIPTION: Read the bucket mask at the start of a body. rest is set to what follows it
+ *
+ * RETURNS:
+ * false if the mask is truncated
+ */
+bool MembershipCodec::decodeMask(FrameView *body, unsigned int *mask, FrameView *rest) {
+	unsigned long value;
+
+	if (!decodePrefix(body, &value, rest)) {
+		return false;
+	}
+	*mask = (unsigned int) value & MP1_ALL_BUCKETS;
+	return true;
+}
+
+/**
+ * FUNCTION NAME: decodePrefix
+ *
+ * DESCRIPTION: Read the varint at the start of a body. rest is set to what follows it
+ *
+ * RETURNS:
+ * false if the varint is truncated
+ */
+bool MembershipCodec::decodePrefix(FrameView *body, unsigned long *value, FrameView *rest) {
+	const char *p = body->data;
+	const char *end = body->data + body->size;
+
+	if (!getVarint(&p, end, value)) {
+		return false;
+	}
+	rest->data = p;
+	rest->size = (int) (end - p);
+	return true;
+}
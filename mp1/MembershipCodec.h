@@ -0,0 +1,88 @@
+/**********************************
+ * FILE NAME: MembershipCodec.h
+ *
+ * DESCRIPTION: Header file of the membership wire format
+ **********************************/
+
+#ifndef _MEMBERSHIPCODEC_H_
+#define _MEMBERSHIPCODEC_H_
+
+#include "stdincludes.h"
+#include "Member.h"
+
+/**
+ * Macros
+ */
+#define MP1_WIRE_VERSION 1
+// id buckets of a membership digest, one bit each in a bucket mask
+#define MP1_DIGEST_BITS 4
+#define MP1_DIGEST_BUCKETS (1 << MP1_DIGEST_BITS)
+#define MP1_ALL_BUCKETS ((1u << MP1_DIGEST_BUCKETS) - 1)
+
+/*
+ * Wire format (version 1), all integers are LEB128 varints:
+ *
+ *   u8 version | u8 msgType | id | zigzag(port) | heartbeat | entry*
+ *
+ *   entry: zigzag(id - previous id) | zigzag(port) | zigzag(heartbeat of header - heartbeat)
+ *
+ * Entries run to the end of the frame. Local timestamps are never sent.
+ *
+ * Digest body: u32 root digest of the view
+ * Bucket digest body: mask of non-empty buckets | u32 digest per set bit, in bit order
+ * Digest push body: mask of differing buckets | entry*
+ * Partial view bodies: argument (walk length or priority) | entry*
+ *
+ * u32 values are little-endian.
+ */
+
+/**
+ * STRUCT NAME: MembershipHdr
+ *
+ * DESCRIPTION: Decoded header of a membership message
+ */
+typedef struct MembershipHdr {
+	int msgType;
+	int id;
+	short port;
+	long heartbeat;
+}MembershipHdr;
+
+/**
+ * STRUCT NAME: FrameView
+ *
+ * DESCRIPTION: Borrowed view of a received frame, only valid until the frame is released
+ */
+typedef struct FrameView {
+	const char *data;
+	int size;
+}FrameView;
+
+/**
+ * CLASS NAME: MembershipCodec
+ *
+ * DESCRIPTION: Packed, versioned encoding of membership messages
+ */
+class MembershipCodec {
+public:
+	static void putVarint(vector<char> &buf, unsigned long value);
+	static bool getVarint(const char **cursor, const char *end, unsigned long *value);
+	static void putFixed32(vector<char> &buf, unsigned int value);
+	static bool getFixed32(const char **cursor, const char *end, unsigned int *value);
+	static unsigned long zigzag(long value);
+	static long unzigzag(unsigned long value);
+	static void beginMessage(vector<char> &buf, int msgType, Address *from, long heartbeat);
+	static void putEntry(vector<char> &buf, long baseHeartbeat, int *prevId, int id, short port, long heartbeat);
+	static bool decodeHeader(FrameView *frame, MembershipHdr *hdr, FrameView *body);
+	static bool decodeEntries(FrameView *body, long baseHeartbeat,
+			void (* visit)(void *, int, short, long), void *env);
+	static unsigned int digestBucket(int id);
+	static unsigned int entryDigest(int id, short port, long epoch);
+	static bool decodeRoot(FrameView *body, unsigned int *root);
+	static void putDigest(vector<char> &buf, unsigned int mask, const unsigned int *digests);
+	static bool decodeDigest(FrameView *body, unsigned int *mask, unsigned int *digests);
+	static bool decodeMask(FrameView *body, unsigned int *mask, FrameView *rest);
+	static bool decodePrefix(FrameView *body, unsigned long *value, FrameView *rest);
+};
+
+#endif /* _MEMBERSHIPCODEC_H_ */
@@ -0,0 +1,66 @@
+/**********************************
+ * FILE NAME: MembershipEvents.h
+ *
+ * DESCRIPTION: Header file of the membership change event stream
+ **********************************/
+
+#ifndef _MEMBERSHIPEVENTS_H_
+#define _MEMBERSHIPEVENTS_H_
+
+#include "stdincludes.h"
+
+/**
+ * Membership event types
+ */
+enum MembershipEventType {
+	// the member entered the membership list, or refreshed its heartbeat after being suspected
+	MEMBER_JOIN,
+	// the member missed its suspect deadline and is no longer gossiped
+	MEMBER_SUSPECT,
+	// the member missed its removal deadline and was dropped from the list
+	MEMBER_FAIL,
+	// the member was dropped from the list without being declared failed, e.g. it left the group
+	MEMBER_REMOVE
+};
+
+/**
+ * STRUCT NAME: MembershipEvent
+ *
+ * DESCRIPTION: One change of the membership list, stamped with the epoch it created
+ */
+typedef struct MembershipEvent {
+	long epoch;
+	int type;
+	int id;
+	short port;
+}MembershipEvent;
+
+/**
+ * CLASS NAME: MembershipEventLog
+ *
+ * DESCRIPTION: Stream of membership changes published by the membership protocol.
+ * 				Every event bumps the membership epoch. Each subscriber reads the stream
+ * 				through its own cursor, and events are dropped once every subscriber has
+ * 				read them. Without subscribers only the epoch advances.
+ */
+class MembershipEventLog {
+private:
+	deque<MembershipEvent> events;
+	// epoch of the last published event
+	long epoch;
+	// epoch of the next event each subscriber will read
+	vector<long> cursors;
+	void trim();
+
+public:
+	MembershipEventLog(): epoch(0) {}
+	long getEpoch() {
+		return epoch;
+	}
+	void publish(int type, int id, short port);
+	int subscribe();
+	bool poll(int subscriber, MembershipEvent *event);
+	void skip(int subscriber);
+};
+
+#endif /* _MEMBERSHIPEVENTS_H_ */
@@ -0,0 +1,197 @@
+/**********************************
+ * FILE NAME: MembershipTable.cpp
+ *
+ * DESCRIPTION: Definition of the structure-of-arrays membership table
+ **********************************/
+
+#include "MembershipTable.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define MT_X86_64 1
+#endif
+
+/*
+ * Kernels. The SSE2 ones are baseline on x86-64, the AVX2 ones are picked at run time.
+ */
+
+static int liveScalar(const int *suspectAt, int n, int i, int now, int *out, int count) {
+	for (; i < n; i++) {
+		out[count] = i;
+		count += suspectAt[i] > now;
+	}
+	return count;
+}
+
+#ifdef MT_X86_64
+static int liveSse2(const int *suspectAt, int n, int now, int *out) {
+	__m128i bound = _mm_set1_epi32(now);
+	int count = 0;
+	int i = 0;
+
+	for (; i + 4 <= n; i += 4) {
+		__m128i block = _mm_loadu_si128((const __m128i *) (suspectAt + i));
+		int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(block, bound)));
+		while (mask) {
+			out[count++] = i + __builtin_ctz(mask);
+			mask &= mask - 1;
+		}
+	}
+	return liveScalar(suspectAt, n, i, now, out, count);
+}
+
+__attribute__((target("avx2")))
+static int liveAvx2(const int *suspectAt, int n, int now, int *out) {
+	__m256i bound = _mm256_set1_epi32(now);
+	int count = 0;
+	int i = 0;
+
+	for (; i + 8 <= n; i += 8) {
+		__m256i block = _mm256_loadu_si256((const __m256i *) (suspectAt + i));
+		int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(block, bound)));
+		while (mask) {
+			out[count++] = i + __builtin_ctz(mask);
+			mask &= mask - 1;
+		}
+	}
+	return liveScalar(suspectAt, n, i, now, out, count);
+}
+
+static bool hasAvx2() {
+	static int avx2 = -1;
+	if (avx2 < 0) {
+		__builtin_cpu_init();
+		avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+	}
+	return avx2 == 1;
+}
+#endif
+
+/**
+ * FUNCTION NAME: clear
+ *
+ * DESCRIPTION: Drop all entries
+ */
+void MembershipTable::clear() {
+	ids.clear();
+	ports.clear();
+	heartbeats.clear();
+	timestamps.clear();
+	suspectAt.clear();
+	index.clear();
+}
+
+/**
+ * FUNCTION NAME: add
+ *
+ * DESCRIPTION: Append an entry
+ *
+ * RETURNS:
+ * position of the new entry
+ */
+int MembershipTable::add(int id, short port, long heartbeat, int timestamp, int suspectAt) {
+	ids.push_back(id);
+	ports.push_back(port);
+	heartbeats.push_back(heartbeat);
+	timestamps.push_back(timestamp);
+	this->suspectAt.push_back(suspectAt);
+	index[addressKey(id, port)] = (int) ids.size() - 1;
+	return (int) ids.size() - 1;
+}
+
+/**
+ * FUNCTION NAME: remove
+ *
+ * DESCRIPTION: Remove the entry at pos in O(1) by moving the last entry into its place
+ */
+void MembershipTable::remove(int pos) {
+	int last = (int) ids.size() - 1;
+
+	index.erase(addressKey(ids[pos], ports[pos]));
+	if (pos != last) {
+		index[addressKey(ids[last], ports[last])] = pos;
+		ids[pos] = ids[last];
+		ports[pos] = ports[last];
+		heartbeats[pos] = heartbeats[last];
+		timestamps[pos] = timestamps[last];
+		suspectAt[pos] = suspectAt[last];
+	}
+	ids.pop_back();
+	ports.pop_back();
+	heartbeats.pop_back();
+	timestamps.pop_back();
+	suspectAt.pop_back();
+}
+
+/**
+ * FUNCTION NAME: find
+ *
+ * DESCRIPTION: Look up a member by id and port in the index
+ *
+ * RETURNS:
+ * position of the member, -1 if it is not in the table
+ */
+int MembershipTable::find(int id, short port) {
+	unordered_map<long, int>::iterator it = index.find(addressKey(id, port));
+	return it == index.end() ? -1 : it->second;
+}
+
+/**
+ * FUNCTION NAME: collectLive
+ *
+ * DESCRIPTION: Fill live with the positions of the members not suspected at time now,
+ * 				in table order. Only the suspectAt column is read.
+ */
+void MembershipTable::collectLive(int now, vector<int> &live) {
+	int n = (int) ids.size();
+	int count;
+
+	// one spare slot for the branch-free scalar tail
+	live.resize(n + 1);
+#ifdef MT_X86_64
+	if (hasAvx2()) {
+		count = liveAvx2(suspectAt.data(), n, now, live.data());
+	} else {
+		count = liveSse2(suspectAt.data(), n, now, live.data());
+	}
+#else
+	count = liveScalar(suspectAt.data(), n, 0, now, live.data(), 0);
+#endif
+	live.resize(count);
+}
+
+/**
+ * FUNCTION NAME: getid
+ *
+ * DESCRIPTION: getter
+ */
+int MembershipTable::getid(int pos) {
+	return ids[pos];
+}
+
+/**
+ * FUNCTION NAME: getport
+ *
+ * DESCRIPTION: getter
+ */
+short MembershipTable::getport(int pos) {
+	return ports[pos];
+}
+
+/**
+ * FUNCTION NAME: getheartbeat
+ *
+ * DESCRIPTION: getter
+ */
+long MembershipTable::getheartbeat(int pos) {
+	return heartbeats[pos];
+}
+
+/**
+ * FUNCTION NAME: gettimestamp
+ *
+ * DESCRIPTION: getter
+ */
+int MembershipTable::gettimestamp(int pos) {
+	return timestamps[pos];
+}
@@ -0,0 +1,58 @@
+/**********************************
+ * FILE NAME: MembershipTable.h
+ *
+ * DESCRIPTION: Header file of the structure-of-arrays membership table
+ **********************************/
+
+#ifndef _MEMBERSHIPTABLE_H_
+#define _MEMBERSHIPTABLE_H_
+
+#include "stdincludes.h"
+#include <unordered_map>
+
+/**
+ * CLASS NAME: MembershipTable
+ *
+ * DESCRIPTION: Membership list stored as one contiguous array per field, so scans only
+ * 				stream the column they test. Expiry scans use SSE2/AVX2 when the CPU has them
+ * 				and a scalar loop otherwise. Lookups go through a hash index from address to
+ * 				position, so merging a list of M entries costs O(M) whatever the table size.
+ * 				Positions are not stable: remove() moves the last entry into the freed slot.
+ */
+class MembershipTable {
+public:
+	vector<int> ids;
+	vector<short> ports;
+	vector<long> heartbeats;
+	// tick of the last fresher heartbeat
+	vector<int> timestamps;
+	// tick from which the member counts as suspected
+	vector<int> suspectAt;
+
+private:
+	// position of each member, keyed by addressKey(id, port)
+	unordered_map<long, int> index;
+
+	static long addressKey(int id, short port) {
+		return ((long) id << 16) | (unsigned short) port;
+	}
+
+public:
+	size_t size() const {
+		return ids.size();
+	}
+	bool empty() const {
+		return ids.empty();
+	}
+	void clear();
+	int add(int id, short port, long heartbeat, int timestamp, int suspectAt);
+	void remove(int pos);
+	int find(int id, short port);
+	void collectLive(int now, vector<int> &live);
+	int getid(int pos);
+	short getport(int pos);
+	long getheartbeat(int pos);
+	int gettimestamp(int pos);
+};
+
+#endif /* _MEMBERSHIPTABLE_H_ */
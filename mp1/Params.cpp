@@ -5,6 +5,7 @@
  **********************************/
 
 #include "Params.h"
+#include "PhiAccrualDetector.h"
 
 /**
  * Constructor
@@ -17,21 +18,124 @@ Params::Params(): PORTNUM(8001) {}
  * DESCRIPTION: Set the parameters for this test case
  */
 void Params::setparams(char *config_file) {
+	char FD[40] = "TIMEOUT";
+	char GS[40] = "PUSH";
+	char VW[40] = "FULL";
+	char TS[40] = "DEFAULT";
+	char DS[40] = "FULL";
+	char key[40];
+	char value[40];
 	FILE *fp = fopen(config_file,"r");
 
+	PHI_THRESHOLD = PHI_DEFAULT_THRESHOLD;
+	INTRODUCERS = 1;
+	ZONES = 1;
+	CROSS_ZONE_DELAY = 0;
+	GRACEFUL_LEAVE = 0;
+
 	fscanf(fp,"MAX_NNB: %d", &MAX_NNB);
 	fscanf(fp,"\nSINGLE_FAILURE: %d", &SINGLE_FAILURE);
 	fscanf(fp,"\nDROP_MSG: %d", &DROP_MSG);
 	fscanf(fp,"\nMSG_DROP_PROB: %lf", &MSG_DROP_PROB);
+	// optional, one "KEY: value" per line in any order
+	while (fscanf(fp, " %39[^:]: %39s", key, value) == 2) {
+		if ( 0 == strcmp(key, "FAILURE_DETECTOR") ) {
+			snprintf(FD, sizeof(FD), "%s", value);
+		}
+		else if ( 0 == strcmp(key, "PHI_THRESHOLD") ) {
+			PHI_THRESHOLD = atof(value);
+		}
+		else if ( 0 == strcmp(key, "INTRODUCERS") ) {
+			INTRODUCERS = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "GOSSIP") ) {
+			snprintf(GS, sizeof(GS), "%s", value);
+		}
+		else if ( 0 == strcmp(key, "VIEW") ) {
+			snprintf(VW, sizeof(VW), "%s", value);
+		}
+		else if ( 0 == strcmp(key, "ZONES") ) {
+			ZONES = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "CROSS_ZONE_DELAY") ) {
+			CROSS_ZONE_DELAY = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "TARGETS") ) {
+			snprintf(TS, sizeof(TS), "%s", value);
+		}
+		else if ( 0 == strcmp(key, "DISSEMINATION") ) {
+			snprintf(DS, sizeof(DS), "%s", value);
+		}
+		else if ( 0 == strcmp(key, "GRACEFUL_LEAVE") ) {
+			GRACEFUL_LEAVE = atoi(value);
+		}
+	}
+
+	if ( 0 == strcmp(FD, "PHI") ) {
+		this->FAILURE_DETECTOR = PHI_ACCRUAL_FD;
+	}
+	else {
+		this->FAILURE_DETECTOR = TIMEOUT_FD;
+	}
+
+	if ( 0 == strcmp(GS, "PUSHPULL") ) {
+		this->GOSSIP = PUSHPULL_GOSSIP;
+	}
+	else {
+		this->GOSSIP = PUSH_GOSSIP;
+	}
+
+	if ( 0 == strcmp(VW, "PARTIAL") ) {
+		this->VIEW = PARTIAL_VIEW;
+	}
+	else {
+		this->VIEW = FULL_VIEW;
+	}
+
+	if ( 0 == strcmp(TS, "HALF") ) {
+		this->TARGETS = HALF_WINDOW_PEERS;
+	}
+	else if ( 0 == strcmp(TS, "RANDOM") ) {
+		this->TARGETS = RANDOM_PEERS;
+	}
+	else if ( 0 == strcmp(TS, "ZONE") ) {
+		this->TARGETS = ZONE_PEERS;
+	}
+	else {
+		// left out, zone-aware targets are the default once zones are configured
+		this->TARGETS = ZONES > 1 ? ZONE_PEERS : HALF_WINDOW_PEERS;
+	}
+
+	if ( 0 == strcmp(DS, "DELTA") ) {
+		this->DISSEMINATION = DELTA_LIST;
+	}
+	else if ( 0 == strcmp(DS, "PIGGYBACK") ) {
+		this->DISSEMINATION = PIGGYBACK_LIST;
+	}
+	else {
+		this->DISSEMINATION = FULL_LIST;
+	}
 
 	cout<<"MAX_NNB: "<<MAX_NNB<<endl;
 	cout<<"SINGLE_FAILURE: "<<SINGLE_FAILURE<<endl;
 	cout<<"DROP_MSG: "<<DROP_MSG<<endl;
 	cout<<"MSG_DROP_PROB: "<<MSG_DROP_PROB<<endl;
+	cout<<"FAILURE_DETECTOR: "<<FD<<endl;
+	cout<<"INTRODUCERS: "<<INTRODUCERS<<endl;
+	cout<<"GOSSIP: "<<GS<<endl;
+	cout<<"VIEW: "<<VW<<endl;
+	cout<<"ZONES: "<<ZONES<<endl;
+	cout<<"CROSS_ZONE_DELAY: "<<CROSS_ZONE_DELAY<<endl;
+	cout<<"TARGETS: "<<TS<<endl;
+	cout<<"DISSEMINATION: "<<DS<<endl;
+	cout<<"GRACEFUL_LEAVE: "<<GRACEFUL_LEAVE<<endl;
 
 	//printf("Parameters of the test case: %d %d %d %lf\n", MAX_NNB, SINGLE_FAILURE, DROP_MSG, MSG_DROP_PROB);
 
 	EN_GPSZ = MAX_NNB;
+	INTRODUCERS = max(1, min(INTRODUCERS, EN_GPSZ));
+	ZONES = max(1, min(ZONES, EN_GPSZ));
+	CROSS_ZONE_DELAY = max(0, CROSS_ZONE_DELAY);
 	STEP_RATE=.25;
 	MAX_MSG_SIZE = 4000;
 	globaltime = 0;
@@ -53,3 +157,13 @@ void Params::setparams(char *config_file) {
 int Params::getcurrtime(){
     return globaltime;
 }
+
+/**
+ * FUNCTION NAME: zoneOf
+ *
+ * DESCRIPTION: Zone of the node with the given id. The ids are split into ZONES contiguous
+ * 				blocks of equal size, the way consecutive hosts share a rack.
+ */
+int Params::zoneOf(int id){
+    return min(max(id - 1, 0) * ZONES / max(EN_GPSZ, 1), ZONES - 1);
+}
@@ -12,6 +12,11 @@
 #include "Member.h"
 
 enum testTYPE { CREATE_TEST, READ_TEST, UPDATE_TEST, DELETE_TEST };
+enum fdTYPE { TIMEOUT_FD, PHI_ACCRUAL_FD };
+enum gossipTYPE { PUSH_GOSSIP, PUSHPULL_GOSSIP };
+enum viewTYPE { FULL_VIEW, PARTIAL_VIEW };
+enum peerTYPE { HALF_WINDOW_PEERS, RANDOM_PEERS, ZONE_PEERS };
+enum disseminationTYPE { FULL_LIST, DELTA_LIST, PIGGYBACK_LIST };
 
 /**
  * CLASS NAME: Params
@@ -31,9 +36,20 @@ public:
 	int globaltime;
 	int allNodesJoined;
 	short PORTNUM;
+	int FAILURE_DETECTOR;		// fixed timeout or phi-accrual
+	double PHI_THRESHOLD;		// phi at which a member is suspected
+	int INTRODUCERS;			// number of introducers, the nodes with the lowest ids
+	int GOSSIP;					// full list push or digest push-pull
+	int VIEW;					// full membership list or HyParView-style partial view
+	int ZONES;					// number of zones, each a contiguous block of ids
+	int CROSS_ZONE_DELAY;		// extra ticks a message takes between zones
+	int TARGETS;				// members a gossip round goes to
+	int DISSEMINATION;			// members a gossip message carries
+	int GRACEFUL_LEAVE;			// the SINGLE_FAILURE node leaves with a LEAVE instead of crashing
 	Params();
 	void setparams(char *);
 	int getcurrtime();
+	int zoneOf(int id);
 };
 
 #endif /* _PARAMS_H_ */
@@ -0,0 +1,122 @@
+/**********************************
+ * FILE NAME: PhiAccrualDetector.cpp
+ *
+ * DESCRIPTION: Definition of the phi-accrual failure detector
+ **********************************/
+
+#include "PhiAccrualDetector.h"
+
+/**
+ * Constructor
+ */
+PhiAccrualDetector::PhiAccrualDetector(double threshold) {
+	setThreshold(threshold);
+}
+
+/**
+ * FUNCTION NAME: setThreshold
+ *
+ * DESCRIPTION: Set the phi threshold and solve once for the standard score that reaches it,
+ * 				so deadlines can be computed without evaluating phi per tick
+ */
+void PhiAccrualDetector::setThreshold(double threshold) {
+	double lo = 0.0, hi = 40.0;
+
+	this->threshold = threshold;
+	for (int i = 0; i < 100; i++) {
+		double mid = (lo + hi) / 2;
+		if (phiOf(mid) < threshold) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	zThreshold = hi;
+}
+
+/**
+ * FUNCTION NAME: reset
+ *
+ * DESCRIPTION: Start an empty window for a member first heard of at time now
+ */
+void PhiAccrualDetector::reset(ArrivalWindow *window, long now) {
+	memset(window, 0, sizeof(ArrivalWindow));
+	window->lastArrival = now;
+}
+
+/**
+ * FUNCTION NAME: heartbeat
+ *
+ * DESCRIPTION: Record a fresh heartbeat seen at time now
+ */
+void PhiAccrualDetector::heartbeat(ArrivalWindow *window, long now) {
+	long interval = now - window->lastArrival;
+	unsigned char sample = (unsigned char) min(max(interval, 0L), 255L);
+
+	if (window->count == PHI_WINDOW) {
+		unsigned char oldest = window->intervals[window->head];
+		window->sum -= oldest;
+		window->sumSquares -= oldest * oldest;
+	} else {
+		window->count++;
+	}
+	window->intervals[window->head] = sample;
+	window->head = (window->head + 1) % PHI_WINDOW;
+	window->sum += sample;
+	window->sumSquares += sample * sample;
+	window->lastArrival = now;
+}
+
+/**
+ * FUNCTION NAME: mean
+ *
+ * DESCRIPTION: Mean inter-arrival time of the window
+ */
+double PhiAccrualDetector::mean(ArrivalWindow *window) {
+	return window->count ? (double) window->sum / window->count : 0.0;
+}
+
+/**
+ * FUNCTION NAME: stddev
+ *
+ * DESCRIPTION: Standard deviation of the inter-arrival times, never below PHI_MIN_STDDEV
+ */
+double PhiAccrualDetector::stddev(ArrivalWindow *window) {
+	double m = mean(window);
+	double variance = window->count ? (double) window->sumSquares / window->count - m * m : 0.0;
+	return max(sqrt(max(variance, 0.0)), PHI_MIN_STDDEV);
+}
+
+/**
+ * FUNCTION NAME: phiOf
+ *
+ * DESCRIPTION: phi for a silence that is z standard deviations past the mean
+ */
+double PhiAccrualDetector::phiOf(double z) {
+	double pLater = 0.5 * erfc(z / sqrt(2.0));
+	return -log10(max(pLater, 1e-300));
+}
+
+/**
+ * FUNCTION NAME: phi
+ *
+ * DESCRIPTION: Suspicion level of a member at time now
+ */
+double PhiAccrualDetector::phi(ArrivalWindow *window, long now) {
+	double z = ((now - window->lastArrival) - mean(window)) / stddev(window);
+	return phiOf(z);
+}
+
+/**
+ * FUNCTION NAME: suspectDeadline
+ *
+ * DESCRIPTION: First tick at which phi of the member passes the threshold.
+ * 				fallback is used while the window holds too few samples.
+ */
+long PhiAccrualDetector::suspectDeadline(ArrivalWindow *window, long fallback) {
+	if (window->count < PHI_MIN_SAMPLES) {
+		return fallback;
+	}
+	double silence = mean(window) + zThreshold * stddev(window);
+	return window->lastArrival + (long) floor(silence) + 1;
+}
@@ -0,0 +1,65 @@
+/**********************************
+ * FILE NAME: TimerWheel.h
+ *
+ * DESCRIPTION: Header file of the hierarchical timer wheel
+ **********************************/
+
+#ifndef _TIMERWHEEL_H_
+#define _TIMERWHEEL_H_
+
+#include "stdincludes.h"
+
+/**
+ * Macros
+ */
+// each level has 2^TW_BITS slots, level n covers 2^(TW_BITS * (n + 1)) ticks
+#define TW_BITS 6
+#define TW_SLOTS (1 << TW_BITS)
+#define TW_LEVELS 3
+#define TW_NONE -1
+
+/**
+ * STRUCT NAME: TimerNode
+ *
+ * DESCRIPTION: One timer, linked into the slot list of the wheel it waits in
+ */
+typedef struct TimerNode {
+	long deadline;
+	int owner;
+	int next;
+	int prev;
+	int level;
+	int slot;
+}TimerNode;
+
+/**
+ * CLASS NAME: TimerWheel
+ *
+ * DESCRIPTION: Hierarchical timing wheel. Timers are handles into a pooled array, so adding,
+ * 				rescheduling and cancelling are O(1) and a tick only touches the timers that are due.
+ * 				Every timer carries an owner value that is passed back on expiry.
+ */
+class TimerWheel {
+private:
+	vector<TimerNode> nodes;
+	int freeList;
+	int heads[TW_LEVELS][TW_SLOTS];
+	long now;
+	void place(int timer);
+	void unlink(int timer);
+	void cascade(int level);
+
+public:
+	TimerWheel();
+	void reset(long now);
+	int add(long deadline, int owner);
+	void reschedule(int timer, long deadline);
+	void cancel(int timer);
+	void setOwner(int timer, int owner);
+	int getOwner(int timer);
+	long getDeadline(int timer);
+	void advance(long to, void (* expire)(void *, int, int), void *env);
+	virtual ~TimerWheel();
+};
+
+#endif /* _TIMERWHEEL_H_ */
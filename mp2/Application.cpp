@@ -65,7 +65,7 @@ Application::Application(char *infile) {
         Address joinaddr;
         joinaddr = getjoinaddr();
         addressOfMemberNode = (Address *) en->ENinit(addressOfMemberNode, par->PORTNUM);
-        mp1[i] = new MP1Node(memberNode, par, en, log, addressOfMemberNode);
+        mp1[i] = MP1Node::create(memberNode, par, en, log, addressOfMemberNode);
         mp2[i] = new MP2Node(memberNode, par, en1, log, addressOfMemberNode);
         log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
         log->LOG(&(mp2[i]->getMemberNode()->addr), "APP MP2");
@@ -421,6 +421,8 @@ void Application::initTestKVPairs() {
  */
 void Application::insertTestKVPairs() {
     int number = 0;
+    // with BATCH, the creates each coordinator is given, sent as one batched request per coordinator
+    map<int, vector<pair<string, string> > > batches;
 
     /*
      * Init a few test key value pairs
@@ -434,7 +436,14 @@ void Application::insertTestKVPairs() {
         // Step 2. Issue a create operation
         log->LOG(&mp2[number]->getMemberNode()->addr, "CREATE OPERATION KEY: %s VALUE: %s at time: %d",
                  it->first.c_str(), it->second.c_str(), par->getcurrtime());
-        mp2[number]->clientCreate(it->first, it->second);
+        if (par->BATCH) {
+            batches[number].push_back(make_pair(it->first, it->second));
+        } else {
+            mp2[number]->clientCreate(it->first, it->second);
+        }
+    }
+    for (map<int, vector<pair<string, string> > >::iterator it = batches.begin(); it != batches.end(); ++it) {
+        mp2[it->first]->clientMultiPut(it->second);
     }
 
     cout << endl << "Sent " << testKVPairs.size() << " create messages to the ring" << endl;
@@ -493,6 +502,8 @@ void Application::readTest() {
     int replicaIdToFail = TERTIARY;
     int nodeToFail;
     bool failedOneNode = false;
+    // with BATCH, the reads each coordinator is given this tick, sent as one batched request
+    map<int, vector<string> > batches;
 
     /**
       * Test 1: Test if value of a single read operation is read correctly in quorum number of nodes
@@ -505,7 +516,7 @@ void Application::readTest() {
         cout << endl << "Reading a valid key.... ... .. . ." << endl;
         log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(),
                  it->second.c_str(), par->getcurrtime());
-        mp2[number]->clientRead(it->first);
+        issueRead(batches, number, it->first);
     }
 
     /** end of test1 **/
@@ -565,7 +576,7 @@ void Application::readTest() {
         cout << endl << "Reading a valid key.... ... .. . ." << endl;
         log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(),
                  it->second.c_str(), par->getcurrtime());
-        mp2[number]->clientRead(it->first);
+        issueRead(batches, number, it->first);
 
         failedOneNode = false;
     }
@@ -643,7 +654,7 @@ void Application::readTest() {
             log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d",
                      it->first.c_str(), it->second.c_str(), par->getcurrtime());
             // This read should fail since at least quorum nodes are not alive
-            mp2[number]->clientRead(it->first);
+            issueRead(batches, number, it->first);
         }
 
         /**
@@ -657,7 +668,7 @@ void Application::readTest() {
             log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d",
                      it->first.c_str(), it->second.c_str(), par->getcurrtime());
             // This read should be successful
-            mp2[number]->clientRead(it->first);
+            issueRead(batches, number, it->first);
         }
     }
 
@@ -702,7 +713,7 @@ void Application::readTest() {
         log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(),
                  it->second.c_str(), par->getcurrtime());
         // This read should fail since at least quorum nodes are not alive
-        mp2[number]->clientRead(it->first);
+        issueRead(batches, number, it->first);
     }
 
     /** end of test 4 **/
@@ -721,11 +732,28 @@ void Application::readTest() {
         log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s at time: %d", invalidKey.c_str(),
                  par->getcurrtime());
         // This read should fail since at least quorum nodes are not alive
-        mp2[number]->clientRead(invalidKey);
+        issueRead(batches, number, invalidKey);
     }
 
     /** end of test 5 **/
 
+    for (map<int, vector<string> >::iterator b = batches.begin(); b != batches.end(); ++b) {
+        mp2[b->first]->clientMultiGet(b->second);
+    }
+}
+
+/**
+ * FUNCTION NAME: issueRead
+ *
+ * DESCRIPTION: Issue a read of the read test at node number, or with BATCH queue it in
+ * 				batches until the end of the tick
+ */
+void Application::issueRead(map<int, vector<string> > &batches, int number, string key) {
+    if (par->BATCH) {
+        batches[number].push_back(key);
+    } else {
+        mp2[number]->clientRead(key);
+    }
 }
 
 /**
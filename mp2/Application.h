@@ -69,6 +69,7 @@ public:
 	void fail();
 	void insertTestKVPairs();
 	int findARandomNodeThatIsAlive();
+	void issueRead(map<int, vector<string> > &batches, int number, string key);
 	void deleteTest();
 	void readTest();
 	void updateTest();
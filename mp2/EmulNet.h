@@ -7,9 +7,10 @@
 #ifndef _EMULNET_H_
 #define _EMULNET_H_
 
-#define MAX_NODES 1000
 #define MAX_TIME 3600
 #define ENBUFFSIZE 30000
+// messages in flight per node, the buffer never holds fewer than ENBUFFSIZE
+#define ENBUFFPERNODE 30
 
 #include "stdincludes.h"
 #include "Params.h"
@@ -17,16 +18,32 @@
 
 using namespace std;
 
+/**
+ * Struct Name: en_payload
+ *
+ * DESCRIPTION: Bytes of a message, followed by the struct. A node that sends the same bytes
+ * 				to several peers in one tick, as gossip does, stores them once and every copy
+ * 				in flight refers to them.
+ */
+typedef struct en_payload {
+	// Copies in flight and receivers still holding the payload
+	int refs;
+	int size;
+}en_payload;
+
 /**
  * Struct Name: en_msg
  */
 typedef struct en_msg {
-	// Number of bytes after the class
+	// Number of payload bytes
 	int size;
 	// Source node
 	Address from;
 	// Destination node
 	Address to;
+	// Tick from which the destination can receive the message
+	int deliverAt;
+	en_payload *payload;
 }en_msg;
 
 /**
@@ -37,17 +54,14 @@ public:
 	int nextid;
 	int currbuffsize;
 	int firsteltindex;
-	en_msg* buff[ENBUFFSIZE];
+	// Messages in flight, one list per destination id
+	vector<vector<en_msg> > inbox;
 	EM() {}
 	EM& operator = (EM &anotherEM) {
 		this->nextid = anotherEM.getNextId();
 		this->currbuffsize = anotherEM.getCurrBuffSize();
 		this->firsteltindex = anotherEM.getFirstEltIndex();
-		int i = this->currbuffsize;
-		while (i > 0) {
-			this->buff[i] = anotherEM.buff[i];
-			i--;
-		}
+		this->inbox = anotherEM.inbox;
 		return *this;
 	}
 	int getNextId() {
@@ -80,8 +94,19 @@ class EmulNet
 { 	
 private:
 	Params* par;
-	int sent_msgs[MAX_NODES + 1][MAX_TIME];
-	int recv_msgs[MAX_NODES + 1][MAX_TIME];
+	// Messages sent and received per node and tick, grown as the run goes on
+	vector<vector<int> > sent_msgs;
+	vector<vector<int> > recv_msgs;
+	// Bytes sent, and messages and bytes sent to another zone, per node
+	vector<long> sent_bytes;
+	vector<long> cross_msgs;
+	vector<long> cross_bytes;
+	// Payload of the last send, reused by the next send of the same bytes by the same node in the same tick
+	en_payload *lastPayload;
+	int lastSrc;
+	int lastTime;
+	static void countAt(vector<int> &perTick, int time);
+	static void releasePayload(en_payload *payload);
 	int enInited;
 	EM emulnet;
 public:
@@ -93,6 +118,7 @@ public:
 	int ENsend(Address *myaddr, Address *toaddr, string data);
 	int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
 	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
+	void ENrelease(char *data);
 	int ENcleanup();
 };
 
@@ -0,0 +1,118 @@
+/**********************************
+ * FILE NAME: Hash64.cpp
+ *
+ * DESCRIPTION: Definition of the 64-bit hash used to place keys and nodes on the ring
+ **********************************/
+
+#include "Hash64.h"
+
+static const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+static const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+	return (x << r) | (x >> (64 - r));
+}
+
+/**
+ * FUNCTION NAME: read64
+ *
+ * DESCRIPTION: Little-endian 64-bit load
+ */
+uint64_t Hash64::read64(const unsigned char *p) {
+	uint64_t v = 0;
+	for (int i = 7; i >= 0; i--) {
+		v = (v << 8) | p[i];
+	}
+	return v;
+}
+
+/**
+ * FUNCTION NAME: read32
+ *
+ * DESCRIPTION: Little-endian 32-bit load
+ */
+uint32_t Hash64::read32(const unsigned char *p) {
+	return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+/**
+ * FUNCTION NAME: round
+ *
+ * DESCRIPTION: Mix one 8-byte lane into an accumulator
+ */
+uint64_t Hash64::round(uint64_t acc, uint64_t input) {
+	acc += input * PRIME64_2;
+	acc = rotl64(acc, 31);
+	return acc * PRIME64_1;
+}
+
+/**
+ * FUNCTION NAME: mergeRound
+ *
+ * DESCRIPTION: Fold one of the four stripe accumulators into the result
+ */
+uint64_t Hash64::mergeRound(uint64_t acc, uint64_t val) {
+	acc ^= round(0, val);
+	return acc * PRIME64_1 + PRIME64_4;
+}
+
+/**
+ * FUNCTION NAME: hash
+ *
+ * DESCRIPTION: XXH64 of len bytes at data
+ */
+uint64_t Hash64::hash(const void *data, size_t len, uint64_t seed) {
+	const unsigned char *p = (const unsigned char *) data;
+	const unsigned char *end = p + len;
+	uint64_t h;
+
+	if (len >= 32) {
+		// four accumulators over 32-byte stripes
+		const unsigned char *limit = end - 32;
+		uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+		uint64_t v2 = seed + PRIME64_2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - PRIME64_1;
+		do {
+			v1 = round(v1, read64(p));
+			v2 = round(v2, read64(p + 8));
+			v3 = round(v3, read64(p + 16));
+			v4 = round(v4, read64(p + 24));
+			p += 32;
+		} while (p <= limit);
+		h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+		h = mergeRound(h, v1);
+		h = mergeRound(h, v2);
+		h = mergeRound(h, v3);
+		h = mergeRound(h, v4);
+	} else {
+		h = seed + PRIME64_5;
+	}
+	h += (uint64_t) len;
+
+	// tail: 8, then 4, then single bytes
+	for (; p + 8 <= end; p += 8) {
+		h ^= round(0, read64(p));
+		h = rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+	}
+	if (p + 4 <= end) {
+		h ^= (uint64_t) read32(p) * PRIME64_1;
+		h = rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+		p += 4;
+	}
+	for (; p < end; p++) {
+		h ^= (*p) * PRIME64_5;
+		h = rotl64(h, 11) * PRIME64_1;
+	}
+
+	// avalanche
+	h ^= h >> 33;
+	h *= PRIME64_2;
+	h ^= h >> 29;
+	h *= PRIME64_3;
+	h ^= h >> 32;
+	return h;
+}
@@ -0,0 +1,34 @@
+/**********************************
+ * FILE NAME: Hash64.h
+ *
+ * DESCRIPTION: Header file of the 64-bit hash used to place keys and nodes on the ring
+ **********************************/
+
+#ifndef HASH64_H_
+#define HASH64_H_
+
+#include "stdincludes.h"
+#include <stdint.h>
+
+/**
+ * CLASS NAME: Hash64
+ *
+ * DESCRIPTION: XXH64 (xxHash, 64-bit variant). Unlike std::hash its output is fixed by the
+ * 				algorithm, so a key lands on the same token in every process and build.
+ * 				Input is read little-endian byte by byte, independent of the host.
+ */
+class Hash64 {
+private:
+	static uint64_t read64(const unsigned char *p);
+	static uint32_t read32(const unsigned char *p);
+	static uint64_t round(uint64_t acc, uint64_t input);
+	static uint64_t mergeRound(uint64_t acc, uint64_t val);
+
+public:
+	static uint64_t hash(const void *data, size_t len, uint64_t seed = 0);
+	static uint64_t hash(const string &s) {
+		return hash(s.data(), s.size());
+	}
+};
+
+#endif /* HASH64_H_ */
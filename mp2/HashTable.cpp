@@ -20,7 +20,9 @@ HashTable::~HashTable() {}
  * false in FAILURE
  */
 bool HashTable::create(string key, string value) {
-	hashTable.emplace(key, value);
+	if (hashTable.emplace(key, value).second) {
+		ringIndex.emplace(Hash64::hash(key), key);
+	}
 	return true;
 }
 
@@ -92,6 +94,14 @@ bool HashTable::deleteKey(string key) {
 		// Could not erase
 		return false;
 	}
+	pair<multimap<uint64_t, string>::iterator, multimap<uint64_t, string>::iterator> slot;
+	slot = ringIndex.equal_range(Hash64::hash(key));
+	for ( multimap<uint64_t, string>::iterator it = slot.first; it != slot.second; it++ ) {
+		if ( it->second == key ) {
+			ringIndex.erase(it);
+			break;
+		}
+	}
 	// Delete was successful
 	return true;
 }
@@ -128,6 +138,7 @@ unsigned long HashTable::currentSize() {
  */
 void HashTable::clear() {
 	hashTable.clear();
+	ringIndex.clear();
 }
 
 /**
@@ -142,3 +153,25 @@ unsigned long HashTable::count(string key) {
 	return (unsigned long) hashTable.count(key);
 }
 
+
+/**
+ * FUNCTION NAME: keysInRange
+ *
+ * DESCRIPTION: Append the keys whose ring position is in (from, to]. The range wraps around
+ * 				the top of the ring when from >= to, and is the whole ring when they are equal.
+ */
+void HashTable::keysInRange(uint64_t from, uint64_t to, vector<string> &keys) {
+	multimap<uint64_t, string>::iterator it;
+	if ( from < to ) {
+		for ( it = ringIndex.upper_bound(from); it != ringIndex.end() && it->first <= to; it++ ) {
+			keys.push_back(it->second);
+		}
+		return;
+	}
+	for ( it = ringIndex.upper_bound(from); it != ringIndex.end(); it++ ) {
+		keys.push_back(it->second);
+	}
+	for ( it = ringIndex.begin(); it != ringIndex.end() && it->first <= to; it++ ) {
+		keys.push_back(it->second);
+	}
+}
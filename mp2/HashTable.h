@@ -13,16 +13,20 @@
 #include "stdincludes.h"
 #include "common.h"
 #include "Entry.h"
+#include "Hash64.h"
 
 /**
  * CLASS NAME: HashTable
  *
  * DESCRIPTION: This class is a wrapper to the map provided by C++ STL.
+ * 				The keys are also indexed by their position on the ring, so the keys of a
+ * 				token range can be listed without a scan of the table.
  *
  */
 class HashTable {
 public:
 	map<string, string> hashTable;
+	multimap<uint64_t, string> ringIndex;
 //public:
 	HashTable();
 	bool create(string key, string value);
@@ -33,6 +37,7 @@ public:
 	unsigned long currentSize();
 	void clear();
 	unsigned long count(string key);
+	void keysInRange(uint64_t from, uint64_t to, vector<string> &keys);
 	virtual ~HashTable();
 };
 
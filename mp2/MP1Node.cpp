@@ -27,10 +27,26 @@ MP1Node::MP1Node(Member *member, Params *params, EmulNet *emul, Log *log, Addres
     this->memberNode->addr = *address;
 }
 
+/**
+ * Overloaded Constructor of the MP1NodeT class, with the policies of the config
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+MP1NodeT<FailureDetector, PeerSelection, Dissemination>::MP1NodeT(Member *member, Params *params, EmulNet *emul, Log *log, Address *address)
+        : MP1Node(member, params, emul, log, address) {
+    this->detector.setThreshold(params->PHI_THRESHOLD);
+    this->viewDigestTick = -1;
+    this->partialView.init(params->EN_GPSZ);
+    this->gossipInterval = GOSSIP_MIN_INTERVAL;
+    this->lastGossip = -1;
+    this->previousGossip = -1;
+    this->gossipEpoch = 0;
+}
+
 /**
  * Destructor of the MP1Node class
  */
-MP1Node::~MP1Node() {}
+template <class FailureDetector, class PeerSelection, class Dissemination>
+MP1NodeT<FailureDetector, PeerSelection, Dissemination>::~MP1NodeT() {}
 
 /**
  * FUNCTION NAME: recvLoop
@@ -38,7 +54,8 @@ MP1Node::~MP1Node() {}
  * DESCRIPTION: This function receives message from the network and pushes into the queue
  * 				This function is called by a node to receive messages currently waiting for it
  */
-int MP1Node::recvLoop() {
+template <class FailureDetector, class PeerSelection, class Dissemination>
+int MP1NodeT<FailureDetector, PeerSelection, Dissemination>::recvLoop() {
     if (memberNode->bFailed) {
         return false;
     } else {
@@ -63,7 +80,8 @@ int MP1Node::enqueueWrapper(void *env, char *buff, int size) {
  * 				All initializations routines for a member.
  * 				Called by the application layer.
  */
-void MP1Node::nodeStart(char *servaddrstr, short servport) {
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::nodeStart(char *servaddrstr, short servport) {
     Address joinaddr;
     joinaddr = getJoinAddress();
 
@@ -91,7 +109,8 @@ void MP1Node::nodeStart(char *servaddrstr, short servport) {
  *
  * DESCRIPTION: Find out who I am and start up
  */
-int MP1Node::initThisNode(Address *joinaddr) {
+template <class FailureDetector, class PeerSelection, class Dissemination>
+int MP1NodeT<FailureDetector, PeerSelection, Dissemination>::initThisNode(Address *joinaddr) {
     /*
      * This function is partially implemented and may require changes
      */
@@ -116,8 +135,8 @@ int MP1Node::initThisNode(Address *joinaddr) {
  *
  * DESCRIPTION: Join the distributed system
  */
-int MP1Node::introduceSelfToGroup(Address *joinaddr) {
-    MessageHdr *msg;
+template <class FailureDetector, class PeerSelection, class Dissemination>
+int MP1NodeT<FailureDetector, PeerSelection, Dissemination>::introduceSelfToGroup(Address *joinaddr) {
 #ifdef DEBUGLOG
     static char s[1024];
 #endif
@@ -130,13 +149,8 @@ int MP1Node::introduceSelfToGroup(Address *joinaddr) {
 #endif
         memberNode->inGroup = true;
     } else {
-        size_t msgsize = sizeof(MessageHdr) + sizeof(joinaddr->addr) + sizeof(long);
-        msg = (MessageHdr *) malloc(msgsize * sizeof(char));
-
-        // create JOINREQ message: format of data is {struct Address myaddr}
-        msg->msgType = JOINREQ;
-        memcpy((char *) (msg + 1), &memberNode->addr.addr, sizeof(memberNode->addr.addr));
-        memcpy((char *) (msg + 1) + sizeof(memberNode->addr.addr), &memberNode->heartbeat, sizeof(long));
+        // create JOINREQ message: a bare header carrying my address and heartbeat
+        MembershipCodec::beginMessage(sendBuf, JOINREQ, &memberNode->addr, memberNode->heartbeat);
 
 #ifdef DEBUGLOG
         cout << memberNode->addr.getAddress() << " Trying to join..." << endl;
@@ -145,9 +159,7 @@ int MP1Node::introduceSelfToGroup(Address *joinaddr) {
 #endif
 
         // send JOINREQ message to introducer member
-        emulNet->ENsend(&memberNode->addr, joinaddr, (char *) msg, msgsize);
-
-        free(msg);
+        emulNet->ENsend(&memberNode->addr, joinaddr, sendBuf.data(), (int) sendBuf.size());
     }
 
     return 1;
@@ -159,7 +171,8 @@ int MP1Node::introduceSelfToGroup(Address *joinaddr) {
  *
  * DESCRIPTION: Wind up this node and clean up state
  */
-int MP1Node::finishUpThisNode() {
+template <class FailureDetector, class PeerSelection, class Dissemination>
+int MP1NodeT<FailureDetector, PeerSelection, Dissemination>::finishUpThisNode() {
     /*
      * Your code goes here
      */
@@ -170,7 +183,22 @@ int MP1Node::finishUpThisNode() {
     memberNode->heartbeat = 0;
     memberNode->pingCounter = TFAIL;
     memberNode->timeOutCounter = -1;
+    for (size_t pos = 0; pos < memberNode->memberList.size(); pos++) {
+        memberNode->memberEvents.publish(MEMBER_REMOVE, memberNode->memberList.getid((int) pos),
+                                         memberNode->memberList.getport((int) pos));
+    }
     memberNode->memberList.clear();
+    memberTimers.clear();
+    memberArrivals.clear();
+    tombstones.clear();
+    pendingJoins.clear();
+    viewDigestTick = -1;
+    partialView.clear();
+    tombstoneExpiry = queue<pair<long, int> >();
+    expiryWheel.reset(par->getcurrtime());
+    gossipInterval = GOSSIP_MIN_INTERVAL;
+    lastGossip = -1;
+    previousGossip = -1;
     return 1;
 }
 
@@ -180,7 +208,8 @@ int MP1Node::finishUpThisNode() {
  * DESCRIPTION: Executed periodically at each member
  * 				Check your messages in queue and perform membership protocol duties
  */
-void MP1Node::nodeLoop() {
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::nodeLoop() {
     if (memberNode->bFailed) {
         return;
     }
@@ -204,17 +233,21 @@ void MP1Node::nodeLoop() {
  *
  * DESCRIPTION: Check messages in the queue and call the respective message handler
  */
-void MP1Node::checkMessages() {
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::checkMessages() {
     void *ptr;
     int size;
 
     // Pop waiting messages from memberNode's mp1q
+    // The handlers only borrow the frame, it is released once they return
     while (!memberNode->mp1q.empty()) {
         ptr = memberNode->mp1q.front().elt;
         size = memberNode->mp1q.front().size;
         memberNode->mp1q.pop();
         recvCallBack((void *) memberNode, (char *) ptr, size);
+        emulNet->ENrelease((char *) ptr);
     }
+    flushJoinReplies();
     return;
 }
 
@@ -223,48 +256,107 @@ void MP1Node::checkMessages() {
  *
  * DESCRIPTION: Message handler for different message types
  */
-bool MP1Node::recvCallBack(void *env, char *data, int size) {
-    //get the messageType
-    MessageHdr *msg;
-    msg = (MessageHdr *) malloc(sizeof(MessageHdr));
-    memcpy(msg, data, sizeof(MessageHdr));
+template <class FailureDetector, class PeerSelection, class Dissemination>
+bool MP1NodeT<FailureDetector, PeerSelection, Dissemination>::recvCallBack(void *env, char *data, int size) {
+    //decode the header in place, frames of another wire version are dropped
+    MembershipHdr hdr;
+    FrameView frame = {data, size};
+    FrameView body;
+    if (!MembershipCodec::decodeHeader(&frame, &hdr, &body)) {
+        return false;
+    }
 
-    switch (msg->msgType) {
+    switch (hdr.msgType) {
         case JOINREQ:
-            return recvJOINREQ(env, data + sizeof(MessageHdr), size - sizeof(MessageHdr));
+            return recvJOINREQ(env, &hdr, &body);
         case JOINREP:
-            return recvJOINREP(env, data + sizeof(MessageHdr), size - sizeof(MessageHdr));
+            return recvJOINREP(env, &hdr, &body);
         case HEARTBEAT:
-            return recvHeartBeat(env, data + sizeof(MessageHdr), size - sizeof(MessageHdr));
+            return recvHeartBeat(env, &hdr, &body);
+        case LEAVE:
+            return recvLEAVE(env, &hdr, &body);
+        case DIGEST:
+            return recvDIGEST(env, &hdr, &body);
+        case DIGESTREP:
+            return recvDIGESTREP(env, &hdr, &body);
+        case DIGESTPUSH:
+            return recvDIGESTPUSH(env, &hdr, &body);
+        case FORWARDJOIN:
+            return recvFORWARDJOIN(env, &hdr, &body);
+        case NEIGHBOR:
+            return recvNEIGHBOR(env, &hdr, &body);
+        case DISCONNECT:
+            return recvDISCONNECT(env, &hdr, &body);
+        case SHUFFLE:
+            return recvSHUFFLE(env, &hdr, &body);
+        case SHUFFLEREPLY:
+            return recvSHUFFLEREPLY(env, &hdr, &body);
     }
     return true;
 }
 
-bool MP1Node::recvJOINREQ(void *env, char *data, int size) {
+template <class FailureDetector, class PeerSelection, class Dissemination>
+bool MP1NodeT<FailureDetector, PeerSelection, Dissemination>::recvJOINREQ(void *env, MembershipHdr *hdr, FrameView *body) {
 //get the address and heartbeat
-    Address *address;
-    address = (Address *) malloc(sizeof(Address));
-    memcpy(address->addr, data, sizeof(address->addr));
-    // cout<<address->getAddress()<<endl;
-
-    long heartbeat;
-    memcpy(&heartbeat, data + sizeof(address->addr), sizeof(long));
-    // cout<<heartbeat<<endl;
-
-    int id = *(int *) (&address->addr);
-    short port = *(short *) (&address->addr[4]);
-
-    updateMemberList(id, port, heartbeat);
+    Address address;
+    memcpy(&address.addr[0], &hdr->id, sizeof(int));
+    memcpy(&address.addr[4], &hdr->port, sizeof(short));
+
+    if (par->VIEW == PARTIAL_VIEW) {
+        // the joiner takes a slot in my active view and a random walk from each of my
+        // other active members finds it more neighbours
+        MembershipTable *table = &memberNode->memberList;
+        addActive(hdr->id, hdr->port, hdr->heartbeat, true);
+        for (size_t pos = 0; pos < table->size(); pos++) {
+            if (table->getid((int) pos) == hdr->id && table->getport((int) pos) == hdr->port) {
+                continue;
+            }
+            vector<MemberListEntry> joiner(1, MemberListEntry(hdr->id, hdr->port, hdr->heartbeat, 0));
+            sendViewMessage(FORWARDJOIN, table->getid((int) pos), table->getport((int) pos), HPV_ARWL, &joiner);
+        }
+    } else {
+        updateMemberList(hdr->id, hdr->port, hdr->heartbeat);
+    }
 
-    sendMemberList(JOINREP, address);
+    // answered once the whole queue has been drained, see flushJoinReplies
+    pendingJoins.push_back(address);
 
     return false;
 }
 
-bool MP1Node::recvJOINREP(void *env, char *data, int size) {
+/**
+ * FUNCTION NAME: flushJoinReplies
+ *
+ * DESCRIPTION: Answer the JOINREQs of this tick. The JOINREP is encoded once, after all
+ * 				joiners were added, so they also learn about each other, and the same bytes
+ * 				go to every joiner.
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::flushJoinReplies() {
+    if (pendingJoins.empty()) {
+        return;
+    }
+    encodeMemberList(JOINREP);
+    for (size_t i = 0; i < pendingJoins.size(); i++) {
+        emulNet->ENsend(&memberNode->addr, &pendingJoins[i], sendBuf.data(), (int) sendBuf.size());
+    }
+    pendingJoins.clear();
+}
 
+template <class FailureDetector, class PeerSelection, class Dissemination>
+bool MP1NodeT<FailureDetector, PeerSelection, Dissemination>::recvJOINREP(void *env, MembershipHdr *hdr, FrameView *body) {
 
-    recvHeartBeat(env, data, size);
+    if (par->VIEW == PARTIAL_VIEW) {
+        // the introducer becomes my first neighbour, its neighbours seed my passive view
+        vector<MemberListEntry> entries;
+        MembershipCodec::decodeEntries(body, hdr->heartbeat, collectEntryWrapper, &entries);
+        addActive(hdr->id, hdr->port, hdr->heartbeat, true);
+        for (size_t i = 0; i < entries.size(); i++) {
+            addPassive(entries[i].id, entries[i].port, entries[i].heartbeat);
+        }
+    } else {
+        recvHeartBeat(env, hdr, body);
+    }
 
     //mark in group
     memberNode->inGroup = true;
@@ -273,21 +365,70 @@ bool MP1Node::recvJOINREP(void *env, char *data, int size) {
     return false;
 }
 
+/**
+ * FUNCTION NAME: updateMemberListWrapper
+ *
+ * DESCRIPTION: Merge one decoded entry into the membership list of the MP1Node passed as env
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::updateMemberListWrapper(void *env, int id, short port, long heartbeat) {
+    ((MP1NodeT *) env)->updateMemberList(id, port, heartbeat);
+}
+
 //if it's in the memberlist, update the heartbeat, else add it to the memberlist
-void MP1Node::updateMemberList(int id, short port, long heartbeat) {
-    vector<MemberListEntry>::iterator it;
-    for (it = memberNode->memberList.begin(); it != memberNode->memberList.end(); it++) {
-        if (it->id == id && it->port == port) {
-            if (it->getheartbeat() < heartbeat) {
-                it->setheartbeat(heartbeat);
-                it->settimestamp(par->getcurrtime());
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::updateMemberList(int id, short port, long heartbeat) {
+    MembershipTable *table = &memberNode->memberList;
+    int pos = table->find(id, port);
+
+    if (pos >= 0) {
+        if (table->heartbeats[pos] < heartbeat) {
+            // the suspect timer of an earlier tick has fired, the member is back
+            if (table->suspectAt[pos] < par->getcurrtime()) {
+                memberNode->memberEvents.publish(MEMBER_JOIN, id, port);
+                viewDigestTick = -1;
             }
-            return;
+            table->heartbeats[pos] = heartbeat;
+            table->timestamps[pos] = par->getcurrtime();
+            FailureDetector::heartbeat(&memberArrivals[pos], par->getcurrtime());
+            table->suspectAt[pos] = (int) suspectDeadline(pos);
+            expiryWheel.reschedule(memberTimers[pos], table->suspectAt[pos]);
         }
+        return;
     }
 
 //    cout << id << ":" << port << " try to join node " <<(int) memberNode->addr.addr[0]<<endl;
 
+    // in the partial view mode only the view protocol adds members
+    if (par->VIEW == PARTIAL_VIEW) {
+        return;
+    }
+
+    //removed members stay out until a heartbeat newer than their tombstone shows up
+    map<long, Tombstone>::iterator tomb = tombstones.find(tombstoneKey(id, port));
+    if (tomb != tombstones.end()) {
+        if (heartbeat <= tomb->second.heartbeat) {
+            return;
+        }
+        tombstones.erase(tomb);
+    }
+
+    insertMember(id, port, heartbeat);
+}
+
+/**
+ * FUNCTION NAME: insertMember
+ *
+ * DESCRIPTION: Add a member that is not in the membership list yet
+ *
+ * RETURNS:
+ * position of the member, -1 for this node itself
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+int MP1NodeT<FailureDetector, PeerSelection, Dissemination>::insertMember(int id, short port, long heartbeat) {
+    MembershipTable *table = &memberNode->memberList;
+    int pos = -1;
+
     //new member, add it to the memberlist
     if (id != *(int *) memberNode->addr.addr || port != (short) memberNode->addr.addr[4]) {
 #ifdef DEBUGLOG
@@ -297,106 +438,749 @@ void MP1Node::updateMemberList(int id, short port, long heartbeat) {
         memcpy(&joinedAddr.addr[4], &port, sizeof(short));
         log->logNodeAdd(&memberNode->addr, &joinedAddr);
 #endif
-        MemberListEntry mle(id, port, heartbeat, par->getcurrtime());
-        memberNode->memberList.push_back(mle);
+        int suspectAt = par->getcurrtime() + TFAIL + 1;
+        pos = table->add(id, port, heartbeat, par->getcurrtime(), suspectAt);
+        memberArrivals.push_back(ArrivalWindow());
+        PhiAccrualDetector::reset(&memberArrivals.back(), par->getcurrtime());
+        memberTimers.push_back(expiryWheel.add(suspectAt, pos));
+        memberNode->memberEvents.publish(MEMBER_JOIN, id, port);
+        viewDigestTick = -1;
     }
+    return pos;
+}
+
+/**
+ * FUNCTION NAME: suspectDeadline
+ *
+ * DESCRIPTION: Tick at which the member at pos is suspected if no fresher heartbeat arrives.
+ * 				The fixed detector waits TFAIL ticks, the phi-accrual detector adapts to the
+ * 				inter-arrival times observed so far and falls back to TFAIL until it has enough of them.
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+long MP1NodeT<FailureDetector, PeerSelection, Dissemination>::suspectDeadline(int pos) {
+    long timeout = memberNode->memberList.timestamps[pos] + TFAIL + 1;
+
+    return FailureDetector::suspectDeadline(&detector, &memberArrivals[pos], timeout);
+}
+
+/**
+ * FUNCTION NAME: expireMemberWrapper
+ *
+ * DESCRIPTION: Expiry callback of the timer wheel, env is the MP1Node
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::expireMemberWrapper(void *env, int timer, int pos) {
+    ((MP1NodeT *) env)->expireMember(timer, pos);
 }
 
-//assemble a JOINREP message and sent it to joiner
-void MP1Node::sendMemberList(enum MsgTypes msgType, Address *address) {
-    long memberSize = memberNode->memberList.size();
-    long dataSize = 0;
-    char *memberListData;
-    memberListData = (char *) malloc(memberSize * sizeof(MemberListEntry));
+/**
+ * FUNCTION NAME: expireMember
+ *
+ * DESCRIPTION: The member at pos reached a deadline without a fresher heartbeat.
+ * 				At the suspect deadline it is no longer gossiped, and it is removed
+ * 				TREMOVE - TFAIL ticks later.
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::expireMember(int timer, int pos) {
+    int id = memberNode->memberList.getid(pos);
+    short port = memberNode->memberList.getport(pos);
+    int removeAt = memberNode->memberList.suspectAt[pos] + TREMOVE - TFAIL;
+
+    if (par->getcurrtime() < removeAt) {
+        memberNode->memberEvents.publish(MEMBER_SUSPECT, id, port);
+        expiryWheel.reschedule(timer, removeAt);
+        return;
+    }
 
-    vector<MemberListEntry>::iterator it;
-    for (it = memberNode->memberList.begin(); it != memberNode->memberList.end();) {
-        if (par->getcurrtime() - it->timestamp > TREMOVE) {
+    memberNode->memberEvents.publish(MEMBER_FAIL, id, port);
 #ifdef DEBUGLOG
-            Address leaveAddr;
-            memcpy(&leaveAddr.addr[0], &it->id, sizeof(int));
-            memcpy(&leaveAddr.addr[4], &it->port, sizeof(short));
-//            cout << "remove " << it->id << ":" << it->port << " from the group" << endl;
-            log->logNodeRemove(&memberNode->addr, &leaveAddr);
+    Address leaveAddr;
+    memcpy(&leaveAddr.addr[0], &id, sizeof(int));
+    memcpy(&leaveAddr.addr[4], &port, sizeof(short));
+    log->logNodeRemove(&memberNode->addr, &leaveAddr);
 #endif
-            memberSize--;
-            memberNode->memberList.erase(it);
-            continue;
-        } else if (par->getcurrtime() - it->timestamp > TFAIL) {
-            memberSize--;
-            it++;
-            continue;
-        } else {
-            MemberListEntry mle(it->id, it->port, it->heartbeat, par->getcurrtime());
-//            if (par->getcurrtime() < 20) {
-//                cout << (int) memberNode->addr.addr[0] << " sent hearbeat to " << it->id << endl;
-//            }
-            memcpy(memberListData + dataSize * sizeof(MemberListEntry), &mle, sizeof(MemberListEntry));
-            it++;
-            dataSize++;
+    addTombstone(id, port, memberNode->memberList.getheartbeat(pos));
+    expiryWheel.cancel(timer);
+    removeMember(pos);
+}
+
+/**
+ * FUNCTION NAME: removeMember
+ *
+ * DESCRIPTION: Remove the entry at pos in O(1) by moving the last entry into its place
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::removeMember(int pos) {
+    int last = (int) memberNode->memberList.size() - 1;
+
+    memberNode->memberList.remove(pos);
+    viewDigestTick = -1;
+    if (pos != last) {
+        memberTimers[pos] = memberTimers[last];
+        memberArrivals[pos] = memberArrivals[last];
+        expiryWheel.setOwner(memberTimers[pos], pos);
+    }
+    memberTimers.pop_back();
+    memberArrivals.pop_back();
+}
+
+/**
+ * FUNCTION NAME: putMemberEntries
+ *
+ * DESCRIPTION: Append the members that are not suspected and fall in one of the given
+ * 				digest buckets to the message in sendBuf. Expiry itself is driven by the timer wheel.
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::putMemberEntries(unsigned int buckets) {
+    MembershipTable *table = &memberNode->memberList;
+    int prevId = 0;
+
+    table->collectLive(par->getcurrtime(), liveMembers);
+    for (size_t i = 0; i < liveMembers.size(); i++) {
+        int pos = liveMembers[i];
+        if (buckets != MP1_ALL_BUCKETS && !(buckets & (1u << MembershipCodec::digestBucket(table->ids[pos])))) {
             continue;
         }
+        MembershipCodec::putEntry(sendBuf, memberNode->heartbeat, &prevId,
+                                  table->ids[pos], table->ports[pos], table->heartbeats[pos]);
     }
+}
 
+/**
+ * FUNCTION NAME: encodeMemberList
+ *
+ * DESCRIPTION: Encode a JOINREP or HEARTBEAT message carrying the members that are not
+ * 				suspected into sendBuf
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::encodeMemberList(enum MsgTypes msgType) {
     memberNode->heartbeat = par->getcurrtime();
+    MembershipCodec::beginMessage(sendBuf, msgType, &memberNode->addr, memberNode->heartbeat);
+    putMemberEntries(MP1_ALL_BUCKETS);
+}
 
-    MessageHdr *rep;
-    size_t msgSize = sizeof(MessageHdr) + sizeof(address->addr) + sizeof(long) * 2 + sizeof(MemberListEntry) * dataSize;
-    rep = (MessageHdr *) malloc(msgSize * sizeof(char));
-    rep->msgType = msgType;
-
-    memcpy((char *) (rep + 1), memberNode->addr.addr, sizeof(address->addr));
-    memcpy((char *) (rep + 1) + sizeof(address->addr), &dataSize, sizeof(long));
-    memcpy((char *) (rep + 1) + sizeof(address->addr) + sizeof(long), &memberNode->heartbeat, sizeof(long));
-    memcpy((char *) (rep + 1) + sizeof(address->addr) + sizeof(long) * 2, memberListData,
-           sizeof(MemberListEntry) * dataSize);
-    emulNet->ENsend(&memberNode->addr, address, (char *) rep, msgSize);
-    free(rep);
-}
-
-void MP1Node::sendHeartBeat() {
-    int targets;
-    targets = (int) (rand() % memberNode->memberList.size());
-//    if (par->getcurrtime() < 20) {
-//        cout << (int) memberNode->addr.addr[0] << " member size is " << memberNode->memberList.size() << endl;
-//    }
-    for (int i = 0; i <= memberNode->memberList.size() / 2; i++) {
-        Address toAdd;
-        int id = memberNode->memberList[(i + targets) % memberNode->memberList.size()].getid();
-        short port = memberNode->memberList[(i + targets) % memberNode->memberList.size()].getport();
-        memcpy(&toAdd.addr[0], &id, sizeof(int));
-        memcpy(&toAdd.addr[4], &port, sizeof(short));
-        sendMemberList(HEARTBEAT, &toAdd);
+/**
+ * FUNCTION NAME: tombstoneKey
+ *
+ * DESCRIPTION: Pack the address of a member into the key of its tombstone
+ */
+long MP1Node::tombstoneKey(int id, short port) {
+    return ((long) id << 16) | (unsigned short) port;
+}
+
+/**
+ * FUNCTION NAME: addTombstone
+ *
+ * DESCRIPTION: Remember a removed member for TTOMBSTONE ticks, so that stale gossip
+ * 				about it does not add it back
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::addTombstone(int id, short port, long heartbeat) {
+    long key = tombstoneKey(id, port);
+    Tombstone tomb = {heartbeat, par->getcurrtime() + TTOMBSTONE};
+
+    tombstones[key] = tomb;
+    tombstoneExpiry.push(make_pair(key, tomb.expireAt));
+}
+
+/**
+ * FUNCTION NAME: expireTombstones
+ *
+ * DESCRIPTION: Drop the tombstones that have lapsed. A key laid again later has a newer
+ * 				expiry in the map, its older queue entry is skipped.
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::expireTombstones() {
+    while (!tombstoneExpiry.empty() && tombstoneExpiry.front().second <= par->getcurrtime()) {
+        map<long, Tombstone>::iterator tomb = tombstones.find(tombstoneExpiry.front().first);
+        if (tomb != tombstones.end() && tomb->second.expireAt <= par->getcurrtime()) {
+            tombstones.erase(tomb);
+        }
+        tombstoneExpiry.pop();
+    }
+}
+
+//assemble a JOINREP or HEARTBEAT message and send it to address
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::sendMemberList(enum MsgTypes msgType, Address *address) {
+    encodeMemberList(msgType);
+    emulNet->ENsend(&memberNode->addr, address, sendBuf.data(), (int) sendBuf.size());
+}
+
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::sendHeartBeat() {
+    if (par->VIEW == PARTIAL_VIEW) {
+        // failure detection only covers the active view, a bare header per neighbour is enough
+        MembershipTable *table = &memberNode->memberList;
+        memberNode->heartbeat = par->getcurrtime();
+        MembershipCodec::beginMessage(sendBuf, HEARTBEAT, &memberNode->addr, memberNode->heartbeat);
+        for (size_t pos = 0; pos < table->size(); pos++) {
+            sendToMember((int) pos);
+        }
+        return;
+    }
+    if (par->GOSSIP == PUSHPULL_GOSSIP) {
+        sendDigest();
+        return;
+    }
+
+    MembershipTable *table = &memberNode->memberList;
+
+    // the gossip is the same for every target, encode it once per round
+    memberNode->heartbeat = par->getcurrtime();
+    MembershipCodec::beginMessage(sendBuf, HEARTBEAT, &memberNode->addr, memberNode->heartbeat);
+    table->collectLive(par->getcurrtime(), liveMembers);
+    Dissemination::putEntries(sendBuf, memberNode->heartbeat, table, liveMembers, previousGossip);
+
+    PeerSelection::select(table, par, *(int *) memberNode->addr.addr, gossipTargets, peerScratch);
+    for (size_t i = 0; i < gossipTargets.size(); i++) {
+        sendToMember(gossipTargets[i]);
+    }
+}
+
+/**
+ * FUNCTION NAME: sendToMember
+ *
+ * DESCRIPTION: Send the message in sendBuf to the member at pos
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::sendToMember(int pos) {
+    Address toAdd;
+    int id = memberNode->memberList.getid(pos);
+    short port = memberNode->memberList.getport(pos);
+
+    memcpy(&toAdd.addr[0], &id, sizeof(int));
+    memcpy(&toAdd.addr[4], &port, sizeof(short));
+    emulNet->ENsend(&memberNode->addr, &toAdd, sendBuf.data(), (int) sendBuf.size());
+}
+
+template <class FailureDetector, class PeerSelection, class Dissemination>
+bool MP1NodeT<FailureDetector, PeerSelection, Dissemination>::recvHeartBeat(void *env, MembershipHdr *hdr, FrameView *body) {
+    // merge the piggybacked entries straight into the membership list
+    MembershipCodec::decodeEntries(body, hdr->heartbeat, updateMemberListWrapper, this);
+    updateMemberList(hdr->id, hdr->port, hdr->heartbeat);
+//    cout<<(int)memberNode->addr.addr[0]<<" receive heartbeat from "<<hdr->id<<":"<<hdr->port<<" - "<<hdr->heartbeat<<endl;
+
+    return false;
+}
+
+/**
+ * FUNCTION NAME: computeViewDigest
+ *
+ * DESCRIPTION: Digest of the live view, this node included, over the address and the
+ * 				heartbeat epoch of each entry. Two nodes whose views agree up to DIGEST_EPOCH
+ * 				ticks of heartbeat have equal digests, a stale entry makes them differ and gets
+ * 				pulled. Recomputed at most once per tick.
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::computeViewDigest() {
+    MembershipTable *table = &memberNode->memberList;
+    int id = *(int *) (&memberNode->addr.addr);
+    short port = *(short *) (&memberNode->addr.addr[4]);
+
+    if (viewDigestTick == par->getcurrtime()) {
+        return;
+    }
+    memset(viewDigest, 0, sizeof(viewDigest));
+    viewDigestMask = 0;
+
+    unsigned int bucket = MembershipCodec::digestBucket(id);
+    viewDigest[bucket] ^= MembershipCodec::entryDigest(id, port, par->getcurrtime() / DIGEST_EPOCH);
+    viewDigestMask |= 1u << bucket;
+
+    table->collectLive(par->getcurrtime(), liveMembers);
+    for (size_t i = 0; i < liveMembers.size(); i++) {
+        int pos = liveMembers[i];
+        bucket = MembershipCodec::digestBucket(table->ids[pos]);
+        viewDigest[bucket] ^= MembershipCodec::entryDigest(table->ids[pos], table->ports[pos],
+                                                           table->heartbeats[pos] / DIGEST_EPOCH);
+        viewDigestMask |= 1u << bucket;
+    }
+
+    viewRoot = 0;
+    for (bucket = 0; bucket < MP1_DIGEST_BUCKETS; bucket++) {
+        viewRoot ^= viewDigest[bucket];
     }
+    viewDigestTick = par->getcurrtime();
 }
 
-bool MP1Node::recvHeartBeat(void *env, char *data, int size) {
-    Address *address;
-    address = (Address *) malloc(sizeof(Address));
-    memcpy(address->addr, data, sizeof(address->addr));
+/**
+ * FUNCTION NAME: sendDigest
+ *
+ * DESCRIPTION: Push-pull gossip. The peer selection targets of the round get the header and
+ * 				the root digest of the view, about a dozen bytes. Bucket digests and entries,
+ * 				fresher heartbeats included, only travel when the roots disagree:
+ * 				DIGEST(root) -> DIGESTREP(bucket digests) -> DIGESTPUSH(entries) -> HEARTBEAT(entries)
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::sendDigest() {
+    MembershipTable *table = &memberNode->memberList;
+
+    computeViewDigest();
+    memberNode->heartbeat = par->getcurrtime();
+    MembershipCodec::beginMessage(sendBuf, DIGEST, &memberNode->addr, memberNode->heartbeat);
+    MembershipCodec::putFixed32(sendBuf, viewRoot);
+
+    PeerSelection::select(table, par, *(int *) memberNode->addr.addr, gossipTargets, peerScratch);
+    for (size_t i = 0; i < gossipTargets.size(); i++) {
+        sendToMember(gossipTargets[i]);
+    }
+}
+
+/**
+ * FUNCTION NAME: recvDIGEST
+ *
+ * DESCRIPTION: Answer a root digest that differs from the own one with the bucket digests
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+bool MP1NodeT<FailureDetector, PeerSelection, Dissemination>::recvDIGEST(void *env, MembershipHdr *hdr, FrameView *body) {
+    unsigned int root;
+
+    updateMemberList(hdr->id, hdr->port, hdr->heartbeat);
+    if (!MembershipCodec::decodeRoot(body, &root)) {
+        return false;
+    }
+    computeViewDigest();
+    if (root == viewRoot) {
+        return false;
+    }
+
+    Address address;
+    memcpy(&address.addr[0], &hdr->id, sizeof(int));
+    memcpy(&address.addr[4], &hdr->port, sizeof(short));
+    memberNode->heartbeat = par->getcurrtime();
+    MembershipCodec::beginMessage(sendBuf, DIGESTREP, &memberNode->addr, memberNode->heartbeat);
+    MembershipCodec::putDigest(sendBuf, viewDigestMask, viewDigest);
+    emulNet->ENsend(&memberNode->addr, &address, sendBuf.data(), (int) sendBuf.size());
+
+    return false;
+}
 
-    int id = *(int *) (&address->addr);
-    short port = *(short *) (&address->addr[4]);
+/**
+ * FUNCTION NAME: recvDIGESTREP
+ *
+ * DESCRIPTION: Compare a peer's bucket digests with the own ones and push the own entries
+ * 				of the differing buckets, with their mask, so the peer can answer with its own
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+bool MP1NodeT<FailureDetector, PeerSelection, Dissemination>::recvDIGESTREP(void *env, MembershipHdr *hdr, FrameView *body) {
+    unsigned int mask, digests[MP1_DIGEST_BUCKETS];
+
+    updateMemberList(hdr->id, hdr->port, hdr->heartbeat);
+    if (!MembershipCodec::decodeDigest(body, &mask, digests)) {
+        return false;
+    }
+
+    computeViewDigest();
+    unsigned int differ = 0;
+    for (int bucket = 0; bucket < MP1_DIGEST_BUCKETS; bucket++) {
+        if (digests[bucket] != viewDigest[bucket]) {
+            differ |= 1u << bucket;
+        }
+    }
+    if (!differ) {
+        return false;
+    }
 
-    long memberListSize;
-    memcpy(&memberListSize, data + sizeof(address->addr), sizeof(long));
-//    if (par->getcurrtime() < 20) {
-//        cout<<"memberListSize that "<<(int)memberNode->addr.addr[0]<<" received from "<<id<< " is "<<memberListSize<<endl;
-//    }
+    Address address;
+    memcpy(&address.addr[0], &hdr->id, sizeof(int));
+    memcpy(&address.addr[4], &hdr->port, sizeof(short));
+    memberNode->heartbeat = par->getcurrtime();
+    MembershipCodec::beginMessage(sendBuf, DIGESTPUSH, &memberNode->addr, memberNode->heartbeat);
+    MembershipCodec::putVarint(sendBuf, differ);
+    putMemberEntries(differ);
+    emulNet->ENsend(&memberNode->addr, &address, sendBuf.data(), (int) sendBuf.size());
 
-    long heartbeat;
-    memcpy(&heartbeat, data + sizeof(address->addr) + sizeof(long), sizeof(long));
+    return false;
+}
 
-    for (int i = 0; i < memberListSize; i++) {
-        MemberListEntry *mle;
-        mle = (MemberListEntry *) malloc(sizeof(MemberListEntry));
-        memcpy(mle, data + sizeof(address->addr) + sizeof(long) * 2 + i * sizeof(MemberListEntry),
-               sizeof(MemberListEntry));
-//        cout<<(int)memberNode->addr.addr[0]<<" receive heartbeat from "<<id<<":"<<port<<" - "<<heartbeat<<endl;
-        updateMemberList(mle->id, mle->port, mle->heartbeat);
+/**
+ * FUNCTION NAME: recvDIGESTPUSH
+ *
+ * DESCRIPTION: Merge the entries a peer pushed for the buckets where our views differ and
+ * 				send the own entries of those buckets back as a HEARTBEAT
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+bool MP1NodeT<FailureDetector, PeerSelection, Dissemination>::recvDIGESTPUSH(void *env, MembershipHdr *hdr, FrameView *body) {
+    unsigned int differ;
+    FrameView entries;
+
+    if (!MembershipCodec::decodeMask(body, &differ, &entries)) {
+        return false;
+    }
+    MembershipCodec::decodeEntries(&entries, hdr->heartbeat, updateMemberListWrapper, this);
+    updateMemberList(hdr->id, hdr->port, hdr->heartbeat);
+
+    Address address;
+    memcpy(&address.addr[0], &hdr->id, sizeof(int));
+    memcpy(&address.addr[4], &hdr->port, sizeof(short));
+    memberNode->heartbeat = par->getcurrtime();
+    MembershipCodec::beginMessage(sendBuf, HEARTBEAT, &memberNode->addr, memberNode->heartbeat);
+    size_t headerSize = sendBuf.size();
+    putMemberEntries(differ);
+    if (sendBuf.size() > headerSize) {
+        emulNet->ENsend(&memberNode->addr, &address, sendBuf.data(), (int) sendBuf.size());
     }
-    updateMemberList(id, port, heartbeat);
-//    cout<<(int)memberNode->addr.addr[0]<<" receive heartbeat from "<<id<<":"<<port<<" - "<<heartbeat<<endl;
+
+    return false;
+}
+
+/**
+ * FUNCTION NAME: collectEntryWrapper
+ *
+ * DESCRIPTION: Append one decoded entry to the vector<MemberListEntry> passed as env
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::collectEntryWrapper(void *env, int id, short port, long heartbeat) {
+    ((vector<MemberListEntry> *) env)->push_back(MemberListEntry(id, port, heartbeat, 0));
+}
+
+/**
+ * FUNCTION NAME: sendViewMessage
+ *
+ * DESCRIPTION: Send a partial view protocol message: the header, one varint argument and
+ * 				optionally a list of entries
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::sendViewMessage(enum MsgTypes msgType, int id, short port, unsigned long arg,
+                              vector<MemberListEntry> *entries) {
+    Address toAdd;
+    int prevId = 0;
+
+    memcpy(&toAdd.addr[0], &id, sizeof(int));
+    memcpy(&toAdd.addr[4], &port, sizeof(short));
+    memberNode->heartbeat = par->getcurrtime();
+    MembershipCodec::beginMessage(sendBuf, msgType, &memberNode->addr, memberNode->heartbeat);
+    MembershipCodec::putVarint(sendBuf, arg);
+    for (size_t i = 0; entries && i < entries->size(); i++) {
+        MemberListEntry *it = &(*entries)[i];
+        MembershipCodec::putEntry(sendBuf, memberNode->heartbeat, &prevId, it->id, it->port, it->heartbeat);
+    }
+    emulNet->ENsend(&memberNode->addr, &toAdd, sendBuf.data(), (int) sendBuf.size());
+}
+
+/**
+ * FUNCTION NAME: addActive
+ *
+ * DESCRIPTION: Put a node in the active view. When the view is full a random member is
+ * 				demoted to the passive view and told so with a DISCONNECT, unless the request
+ * 				has low priority, in which case the node itself is turned away.
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::addActive(int id, short port, long heartbeat, bool highPriority) {
+    MembershipTable *table = &memberNode->memberList;
+
+    if ((id == *(int *) memberNode->addr.addr && port == *(short *) &memberNode->addr.addr[4])
+        || table->find(id, port) >= 0) {
+        return;
+    }
+    if ((int) table->size() >= partialView.activeSize) {
+        if (!highPriority) {
+            sendViewMessage(DISCONNECT, id, port, 0, NULL);
+            addPassive(id, port, heartbeat);
+            return;
+        }
+        int victim = rand() % (int) table->size();
+        int victimId = table->getid(victim);
+        short victimPort = table->getport(victim);
+        long victimHeartbeat = table->getheartbeat(victim);
+        sendViewMessage(DISCONNECT, victimId, victimPort, 0, NULL);
+        dropActive(victim);
+        addPassive(victimId, victimPort, victimHeartbeat);
+    }
+    partialView.remove(id, port);
+    tombstones.erase(tombstoneKey(id, port));
+    insertMember(id, port, heartbeat);
+}
+
+/**
+ * FUNCTION NAME: dropActive
+ *
+ * DESCRIPTION: Take a member out of the active view without declaring it failed
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::dropActive(int pos) {
+    memberNode->memberEvents.publish(MEMBER_REMOVE, memberNode->memberList.getid(pos),
+                                     memberNode->memberList.getport(pos));
+    expiryWheel.cancel(memberTimers[pos]);
+    removeMember(pos);
+}
+
+/**
+ * FUNCTION NAME: addPassive
+ *
+ * DESCRIPTION: Remember a node in the passive view, unless it is this node, an active member
+ * 				or tombstoned
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::addPassive(int id, short port, long heartbeat) {
+    if ((id == *(int *) memberNode->addr.addr && port == *(short *) &memberNode->addr.addr[4])
+        || memberNode->memberList.find(id, port) >= 0) {
+        return;
+    }
+    map<long, Tombstone>::iterator tomb = tombstones.find(tombstoneKey(id, port));
+    if (tomb != tombstones.end() && heartbeat <= tomb->second.heartbeat) {
+        return;
+    }
+    partialView.add(id, port, heartbeat);
+}
+
+/**
+ * FUNCTION NAME: fillActiveView
+ *
+ * DESCRIPTION: Ask one random passive node a tick to become a neighbour while the active
+ * 				view is short. The request has high priority when this node has no neighbour left.
+ * 				The node only enters the active view once it accepts, so a dead passive entry
+ * 				is simply dropped.
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::fillActiveView() {
+    MemberListEntry entry;
+    bool highPriority = memberNode->memberList.empty();
+
+    if ((int) memberNode->memberList.size() >= partialView.activeSize || !partialView.takeRandom(&entry)) {
+        return;
+    }
+    sendViewMessage(NEIGHBOR, entry.id, entry.port, highPriority ? HPV_NEIGHBOR_HIGH : HPV_NEIGHBOR_LOW, NULL);
+}
+
+/**
+ * FUNCTION NAME: shuffle
+ *
+ * DESCRIPTION: Start a random walk carrying this node and a sample of both views, so that
+ * 				passive views keep mixing
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::shuffle() {
+    MembershipTable *table = &memberNode->memberList;
+    vector<MemberListEntry> entries;
+
+    if (table->empty()) {
+        return;
+    }
+    entries.push_back(MemberListEntry(*(int *) memberNode->addr.addr, *(short *) &memberNode->addr.addr[4],
+                                      par->getcurrtime(), 0));
+    for (int i = 0; i < HPV_SHUFFLE_ACTIVE && i < (int) table->size(); i++) {
+        int pos = rand() % (int) table->size();
+        entries.push_back(MemberListEntry(table->getid(pos), table->getport(pos), table->getheartbeat(pos), 0));
+    }
+    partialView.sample(HPV_SHUFFLE_PASSIVE, entries);
+
+    int target = rand() % (int) table->size();
+    sendViewMessage(SHUFFLE, table->getid(target), table->getport(target), HPV_ARWL, &entries);
+}
+
+/**
+ * FUNCTION NAME: recvFORWARDJOIN
+ *
+ * DESCRIPTION: Random walk announcing a joiner. The joiner enters the passive view at
+ * 				HPV_PRWL steps and the active view where the walk ends.
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+bool MP1NodeT<FailureDetector, PeerSelection, Dissemination>::recvFORWARDJOIN(void *env, MembershipHdr *hdr, FrameView *body) {
+    MembershipTable *table = &memberNode->memberList;
+    unsigned long ttl;
+    FrameView rest;
+    vector<MemberListEntry> joiner;
+
+    updateMemberList(hdr->id, hdr->port, hdr->heartbeat);
+    if (!MembershipCodec::decodePrefix(body, &ttl, &rest)
+        || !MembershipCodec::decodeEntries(&rest, hdr->heartbeat, collectEntryWrapper, &joiner)
+        || joiner.empty()) {
+        return false;
+    }
+    MemberListEntry *j = &joiner[0];
+
+    if (ttl == 0 || table->size() <= 1) {
+        addActive(j->id, j->port, j->heartbeat, true);
+        sendViewMessage(NEIGHBOR, j->id, j->port, HPV_NEIGHBOR_ACCEPT, NULL);
+        return false;
+    }
+    if (ttl == HPV_PRWL) {
+        addPassive(j->id, j->port, j->heartbeat);
+    }
+    // walk on through a neighbour other than the sender and the joiner
+    int start = rand() % (int) table->size();
+    for (int i = 0; i < (int) table->size(); i++) {
+        int pos = (start + i) % (int) table->size();
+        int id = table->getid(pos);
+        short port = table->getport(pos);
+        if ((id == hdr->id && port == hdr->port) || (id == j->id && port == j->port)) {
+            continue;
+        }
+        sendViewMessage(FORWARDJOIN, id, port, ttl - 1, &joiner);
+        return false;
+    }
+    addActive(j->id, j->port, j->heartbeat, true);
+    sendViewMessage(NEIGHBOR, j->id, j->port, HPV_NEIGHBOR_ACCEPT, NULL);
+    return false;
+}
+
+/**
+ * FUNCTION NAME: recvNEIGHBOR
+ *
+ * DESCRIPTION: A node asks to become an active neighbour, or accepts this node as one.
+ * 				High priority requests are always accepted, low priority ones only while the
+ * 				active view has room; addActive turns the others away with a DISCONNECT.
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+bool MP1NodeT<FailureDetector, PeerSelection, Dissemination>::recvNEIGHBOR(void *env, MembershipHdr *hdr, FrameView *body) {
+    unsigned long kind;
+    FrameView rest;
+
+    if (!MembershipCodec::decodePrefix(body, &kind, &rest)) {
+        return false;
+    }
+    addActive(hdr->id, hdr->port, hdr->heartbeat, kind != HPV_NEIGHBOR_LOW);
+    if (kind != HPV_NEIGHBOR_ACCEPT && memberNode->memberList.find(hdr->id, hdr->port) >= 0) {
+        sendViewMessage(NEIGHBOR, hdr->id, hdr->port, HPV_NEIGHBOR_ACCEPT, NULL);
+    }
+    updateMemberList(hdr->id, hdr->port, hdr->heartbeat);
+    return false;
+}
+
+/**
+ * FUNCTION NAME: recvDISCONNECT
+ *
+ * DESCRIPTION: A neighbour dropped this node from its active view, or turned it away.
+ * 				The link is symmetric, so it moves to the passive view here too.
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+bool MP1NodeT<FailureDetector, PeerSelection, Dissemination>::recvDISCONNECT(void *env, MembershipHdr *hdr, FrameView *body) {
+    int pos = memberNode->memberList.find(hdr->id, hdr->port);
+
+    if (pos >= 0) {
+        dropActive(pos);
+    }
+    addPassive(hdr->id, hdr->port, hdr->heartbeat);
+    return false;
+}
+
+/**
+ * FUNCTION NAME: recvSHUFFLE
+ *
+ * DESCRIPTION: Forward a shuffle walk, or end it here: answer the origin with as many
+ * 				passive entries as it sent and keep the ones it sent
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+bool MP1NodeT<FailureDetector, PeerSelection, Dissemination>::recvSHUFFLE(void *env, MembershipHdr *hdr, FrameView *body) {
+    MembershipTable *table = &memberNode->memberList;
+    unsigned long ttl;
+    FrameView rest;
+    vector<MemberListEntry> entries;
+
+    updateMemberList(hdr->id, hdr->port, hdr->heartbeat);
+    if (!MembershipCodec::decodePrefix(body, &ttl, &rest)
+        || !MembershipCodec::decodeEntries(&rest, hdr->heartbeat, collectEntryWrapper, &entries)
+        || entries.empty()) {
+        return false;
+    }
+    MemberListEntry origin = entries[0];
+
+    if (ttl > 1 && table->size() > 1) {
+        int start = rand() % (int) table->size();
+        for (int i = 0; i < (int) table->size(); i++) {
+            int pos = (start + i) % (int) table->size();
+            int id = table->getid(pos);
+            short port = table->getport(pos);
+            if ((id == hdr->id && port == hdr->port) || (id == origin.id && port == origin.port)) {
+                continue;
+            }
+            sendViewMessage(SHUFFLE, id, port, ttl - 1, &entries);
+            return false;
+        }
+    }
+
+    vector<MemberListEntry> reply;
+    partialView.sample((int) entries.size(), reply);
+    sendViewMessage(SHUFFLEREPLY, origin.id, origin.port, 0, &reply);
+    for (size_t i = 0; i < entries.size(); i++) {
+        addPassive(entries[i].id, entries[i].port, entries[i].heartbeat);
+    }
+    return false;
+}
+
+/**
+ * FUNCTION NAME: recvSHUFFLEREPLY
+ *
+ * DESCRIPTION: Keep the passive entries sent back by the node that ended a shuffle walk
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+bool MP1NodeT<FailureDetector, PeerSelection, Dissemination>::recvSHUFFLEREPLY(void *env, MembershipHdr *hdr, FrameView *body) {
+    unsigned long ignored;
+    FrameView rest;
+    vector<MemberListEntry> entries;
+
+    if (!MembershipCodec::decodePrefix(body, &ignored, &rest)) {
+        return false;
+    }
+    MembershipCodec::decodeEntries(&rest, hdr->heartbeat, collectEntryWrapper, &entries);
+    for (size_t i = 0; i < entries.size(); i++) {
+        addPassive(entries[i].id, entries[i].port, entries[i].heartbeat);
+    }
+    addPassive(hdr->id, hdr->port, hdr->heartbeat);
+    return false;
+}
+
+/**
+ * FUNCTION NAME: leaveGroup
+ *
+ * DESCRIPTION: Leave the group while the run goes on. The members drop this node as soon as
+ * 				the LEAVE arrives instead of waiting out TREMOVE. Called by the application layer.
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::leaveGroup() {
+    if (memberNode->inGroup && !memberNode->bFailed) {
+        sendLeave();
+    }
+    memberNode->inGroup = false;
+}
+
+/**
+ * FUNCTION NAME: sendLeave
+ *
+ * DESCRIPTION: Tell every member that this node is leaving the group. The LEAVE is a bare
+ * 				header, its heartbeat is newer than any gossip about this node.
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::sendLeave() {
+    MembershipTable *table = &memberNode->memberList;
+
+    memberNode->heartbeat = par->getcurrtime();
+    MembershipCodec::beginMessage(sendBuf, LEAVE, &memberNode->addr, memberNode->heartbeat);
+    for (size_t pos = 0; pos < table->size(); pos++) {
+        Address toAdd;
+        int id = table->getid((int) pos);
+        short port = table->getport((int) pos);
+        memcpy(&toAdd.addr[0], &id, sizeof(int));
+        memcpy(&toAdd.addr[4], &port, sizeof(short));
+        emulNet->ENsend(&memberNode->addr, &toAdd, sendBuf.data(), (int) sendBuf.size());
+    }
+}
+
+/**
+ * FUNCTION NAME: recvLEAVE
+ *
+ * DESCRIPTION: Remove the leaving member at once and tombstone it, so that gossip still
+ * 				carrying it does not add it back
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+bool MP1NodeT<FailureDetector, PeerSelection, Dissemination>::recvLEAVE(void *env, MembershipHdr *hdr, FrameView *body) {
+    int pos = memberNode->memberList.find(hdr->id, hdr->port);
+
+    partialView.remove(hdr->id, hdr->port);
+    if (pos >= 0) {
+#ifdef DEBUGLOG
+        Address leaveAddr;
+        memcpy(&leaveAddr.addr[0], &hdr->id, sizeof(int));
+        memcpy(&leaveAddr.addr[4], &hdr->port, sizeof(short));
+        log->logNodeRemove(&memberNode->addr, &leaveAddr);
+#endif
+        memberNode->memberEvents.publish(MEMBER_REMOVE, hdr->id, hdr->port);
+        expiryWheel.cancel(memberTimers[pos]);
+        removeMember(pos);
+    }
+    addTombstone(hdr->id, hdr->port, hdr->heartbeat);
 
     return false;
 }
@@ -408,18 +1192,56 @@ bool MP1Node::recvHeartBeat(void *env, char *data, int size) {
  * 				the nodes
  * 				Propagate your membership list
  */
-void MP1Node::nodeLoopOps() {
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::nodeLoopOps() {
 
     /*
      * Your code goes here
      */
-    if (memberNode->memberList.size() > 0) {
+    // only the members whose deadline is due this tick are touched
+    expiryWheel.advance(par->getcurrtime(), expireMemberWrapper, this);
+    expireTombstones();
+
+    if (par->VIEW == PARTIAL_VIEW) {
+        fillActiveView();
+        if (par->getcurrtime() % HPV_SHUFFLE_PERIOD == 0) {
+            shuffle();
+        }
+    }
+
+    if (memberNode->memberList.size() > 0 && gossipDue()) {
         sendHeartBeat();
     }
 
     return;
 }
 
+/**
+ * FUNCTION NAME: gossipDue
+ *
+ * DESCRIPTION: Decide whether this tick is a gossip round. Every quiet round doubles the
+ * 				interval up to GOSSIP_MAX_INTERVAL. Any membership event since the last round,
+ * 				a join, suspicion, failure or leave, brings it back to GOSSIP_MIN_INTERVAL and
+ * 				gossips right away so the change spreads at full speed.
+ */
+template <class FailureDetector, class PeerSelection, class Dissemination>
+bool MP1NodeT<FailureDetector, PeerSelection, Dissemination>::gossipDue() {
+    int now = par->getcurrtime();
+    long epoch = memberNode->memberEvents.getEpoch();
+
+    if (epoch != gossipEpoch) {
+        gossipEpoch = epoch;
+        gossipInterval = GOSSIP_MIN_INTERVAL;
+    } else if (lastGossip >= 0 && now - lastGossip < gossipInterval) {
+        return false;
+    } else if (lastGossip >= 0) {
+        gossipInterval = min(gossipInterval * 2, GOSSIP_MAX_INTERVAL);
+    }
+    previousGossip = lastGossip;
+    lastGossip = now;
+    return true;
+}
+
 /**
  * FUNCTION NAME: isNullAddress
  *
@@ -432,25 +1254,49 @@ int MP1Node::isNullAddress(Address *addr) {
 /**
  * FUNCTION NAME: getJoinAddress
  *
- * DESCRIPTION: Returns the Address of the coordinator
+ * DESCRIPTION: Returns the Address of the introducer this node joins through
  */
 Address MP1Node::getJoinAddress() {
     Address joinaddr;
 
-    memset(&joinaddr, 0, sizeof(Address));
-    *(int *) (&joinaddr.addr) = 1;
+    memset(joinaddr.addr, 0, sizeof(joinaddr.addr));
+    *(int *) (&joinaddr.addr) = introducerFor(*(int *) (&memberNode->addr.addr));
     *(short *) (&joinaddr.addr[4]) = 0;
 
     return joinaddr;
 }
 
+/**
+ * FUNCTION NAME: introducerFor
+ *
+ * DESCRIPTION: Spread the joiners over the INTRODUCERS nodes with the lowest ids by a hash
+ * 				of the joiner id. Node 1 boots the group and the other introducers join
+ * 				through it, since they start before any other node.
+ */
+int MP1Node::introducerFor(int id) {
+    if (id <= par->INTRODUCERS) {
+        return 1;
+    }
+    unsigned int h = (unsigned int) id * 2654435761u;
+    return 1 + (int) ((h >> 16) % (unsigned int) par->INTRODUCERS);
+}
+
 /**
  * FUNCTION NAME: initMemberListTable
  *
  * DESCRIPTION: Initialize the membership list
  */
-void MP1Node::initMemberListTable(Member *memberNode) {
+template <class FailureDetector, class PeerSelection, class Dissemination>
+void MP1NodeT<FailureDetector, PeerSelection, Dissemination>::initMemberListTable(Member *memberNode) {
     memberNode->memberList.clear();
+    memberTimers.clear();
+    memberArrivals.clear();
+    tombstones.clear();
+    pendingJoins.clear();
+    viewDigestTick = -1;
+    partialView.clear();
+    tombstoneExpiry = queue<pair<long, int> >();
+    expiryWheel.reset(par->getcurrtime());
 }
 
 /**
@@ -462,3 +1308,50 @@ void MP1Node::printAddress(Address *addr) {
     printf("%d.%d.%d.%d:%d \n", addr->addr[0], addr->addr[1], addr->addr[2],
            addr->addr[3], *(short *) &addr->addr[4]);
 }
+
+/**
+ * FUNCTION NAME: createWithDissemination
+ *
+ * DESCRIPTION: Last step of MP1Node::create, picks the dissemination policy
+ */
+template <class FailureDetector, class PeerSelection>
+static MP1Node *createWithDissemination(Member *member, Params *params, EmulNet *emul, Log *log, Address *address) {
+    switch (params->DISSEMINATION) {
+        case DELTA_LIST:
+            return new MP1NodeT<FailureDetector, PeerSelection, DeltaGossip>(member, params, emul, log, address);
+        case PIGGYBACK_LIST:
+            return new MP1NodeT<FailureDetector, PeerSelection, PiggybackGossip>(member, params, emul, log, address);
+        default:
+            return new MP1NodeT<FailureDetector, PeerSelection, FullListGossip>(member, params, emul, log, address);
+    }
+}
+
+/**
+ * FUNCTION NAME: createWithPeers
+ *
+ * DESCRIPTION: Second step of MP1Node::create, picks the peer selection policy
+ */
+template <class FailureDetector>
+static MP1Node *createWithPeers(Member *member, Params *params, EmulNet *emul, Log *log, Address *address) {
+    switch (params->TARGETS) {
+        case RANDOM_PEERS:
+            return createWithDissemination<FailureDetector, RandomPeers>(member, params, emul, log, address);
+        case ZONE_PEERS:
+            return createWithDissemination<FailureDetector, ZonePeers>(member, params, emul, log, address);
+        default:
+            return createWithDissemination<FailureDetector, HalfWindowPeers>(member, params, emul, log, address);
+    }
+}
+
+/**
+ * FUNCTION NAME: create
+ *
+ * DESCRIPTION: Build the membership node with the policies the config asks for. Every
+ * 				combination is instantiated here, so the rest of the tree only sees MP1Node.
+ */
+MP1Node *MP1Node::create(Member *member, Params *params, EmulNet *emul, Log *log, Address *address) {
+    if (params->FAILURE_DETECTOR == PHI_ACCRUAL_FD) {
+        return createWithPeers<PhiDetector>(member, params, emul, log, address);
+    }
+    return createWithPeers<TimeoutDetector>(member, params, emul, log, address);
+}
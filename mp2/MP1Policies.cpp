@@ -0,0 +1,133 @@
+/**********************************
+ * FILE NAME: MP1Policies.cpp
+ *
+ * DESCRIPTION: Definition of the compile-time policies of the membership protocol
+ **********************************/
+
+#include "MP1Policies.h"
+
+/**
+ * FUNCTION NAME: select
+ *
+ * DESCRIPTION: Half the table plus one, in table order from a random start
+ */
+void HalfWindowPeers::select(MembershipTable *table, Params *par, int self, vector<int> &targets, vector<int> &scratch) {
+	int size = (int) table->size();
+	int start = rand() % size;
+
+	targets.clear();
+	for (int i = 0; i <= size / 2; i++) {
+		targets.push_back((i + start) % size);
+	}
+}
+
+/**
+ * FUNCTION NAME: select
+ *
+ * DESCRIPTION: A fixed fanout of distinct random members, by a partial Fisher-Yates shuffle
+ */
+void RandomPeers::select(MembershipTable *table, Params *par, int self, vector<int> &targets, vector<int> &scratch) {
+	int size = (int) table->size();
+	int fanout = min(size, (int) ceil(log2(size + 1)) + GOSSIP_RANDOM_EXTRA);
+
+	scratch.resize(size);
+	for (int i = 0; i < size; i++) {
+		scratch[i] = i;
+	}
+	targets.clear();
+	for (int i = 0; i < fanout; i++) {
+		int pick = i + rand() % (size - i);
+		swap(scratch[i], scratch[pick]);
+		targets.push_back(scratch[i]);
+	}
+}
+
+/**
+ * FUNCTION NAME: select
+ *
+ * DESCRIPTION: Half of this node's zone from a random start, then a few distinct random
+ * 				members of the other zones
+ */
+void ZonePeers::select(MembershipTable *table, Params *par, int self, vector<int> &targets, vector<int> &scratch) {
+	int zone = par->zoneOf(self);
+
+	targets.clear();
+	scratch.clear();
+	for (size_t pos = 0; pos < table->size(); pos++) {
+		if (par->zoneOf(table->ids[pos]) == zone) {
+			targets.push_back((int) pos);
+		} else {
+			scratch.push_back((int) pos);
+		}
+	}
+
+	// keep a window of half the zone, rotated to a random start
+	int size = (int) targets.size();
+	if (size > 0) {
+		int start = rand() % size;
+		rotate(targets.begin(), targets.begin() + start, targets.end());
+		targets.resize(size / 2 + 1);
+	}
+	// partial Fisher-Yates, so the cross-zone targets of a round are distinct
+	for (int i = 0; i < GOSSIP_CROSS_ZONE && i < (int) scratch.size(); i++) {
+		int pick = i + rand() % ((int) scratch.size() - i);
+		swap(scratch[i], scratch[pick]);
+		targets.push_back(scratch[i]);
+	}
+}
+
+/**
+ * FUNCTION NAME: putEntries
+ *
+ * DESCRIPTION: Append every live member
+ */
+void FullListGossip::putEntries(vector<char> &buf, long heartbeat, MembershipTable *table, vector<int> &live, int since) {
+	int prevId = 0;
+
+	for (size_t i = 0; i < live.size(); i++) {
+		int pos = live[i];
+		MembershipCodec::putEntry(buf, heartbeat, &prevId, table->ids[pos], table->ports[pos], table->heartbeats[pos]);
+	}
+}
+
+/**
+ * FUNCTION NAME: putEntries
+ *
+ * DESCRIPTION: Append the live members whose heartbeat was refreshed after tick since
+ */
+void DeltaGossip::putEntries(vector<char> &buf, long heartbeat, MembershipTable *table, vector<int> &live, int since) {
+	int prevId = 0;
+
+	for (size_t i = 0; i < live.size(); i++) {
+		int pos = live[i];
+		if (table->timestamps[pos] > since) {
+			MembershipCodec::putEntry(buf, heartbeat, &prevId, table->ids[pos], table->ports[pos], table->heartbeats[pos]);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: putEntries
+ *
+ * DESCRIPTION: Append a slice of the live members starting at a random one. The slice is a
+ * 				1/GOSSIP_PIGGYBACK_SHARE of the list, never below GOSSIP_PIGGYBACK entries.
+ */
+void PiggybackGossip::putEntries(vector<char> &buf, long heartbeat, MembershipTable *table, vector<int> &live, int since) {
+	int prevId = 0;
+	int size = (int) live.size();
+	int count = min(size, max(GOSSIP_PIGGYBACK, size / GOSSIP_PIGGYBACK_SHARE));
+
+	if (count == 0) {
+		return;
+	}
+	int start = rand() % size;
+	// the slice wraps around the end of the list
+	for (int i = start; i < size && i < start + count; i++) {
+		int pos = live[i];
+		MembershipCodec::putEntry(buf, heartbeat, &prevId, table->ids[pos], table->ports[pos], table->heartbeats[pos]);
+	}
+	for (int i = 0; i < start + count - size; i++) {
+		int pos = live[i];
+		MembershipCodec::putEntry(buf, heartbeat, &prevId, table->ids[pos], table->ports[pos], table->heartbeats[pos]);
+	}
+}
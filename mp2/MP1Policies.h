@@ -0,0 +1,130 @@
+/**********************************
+ * FILE NAME: MP1Policies.h
+ *
+ * DESCRIPTION: Header file of the compile-time policies of the membership protocol
+ **********************************/
+
+#ifndef _MP1POLICIES_H_
+#define _MP1POLICIES_H_
+
+#include "stdincludes.h"
+#include "Params.h"
+#include "MembershipTable.h"
+#include "MembershipCodec.h"
+#include "PhiAccrualDetector.h"
+
+/**
+ * Macros
+ */
+// extra targets of RandomPeers on top of log2 of the group size
+#define GOSSIP_RANDOM_EXTRA 2
+// members of other zones each gossip round of ZonePeers also goes to
+#define GOSSIP_CROSS_ZONE 1
+// smallest number of entries, and share of the list, carried by one PiggybackGossip message
+#define GOSSIP_PIGGYBACK 8
+#define GOSSIP_PIGGYBACK_SHARE 4
+
+/*
+ * The membership node is a template over one policy of each kind below, so the calls it makes
+ * into them on the per-message path are resolved at compile time. Every policy is a struct of
+ * static functions, Application picks the instantiation from the config.
+ */
+
+/**
+ * STRUCT NAME: TimeoutDetector
+ *
+ * DESCRIPTION: Failure detector policy: a member is suspected TFAIL ticks after its last
+ * 				fresher heartbeat. Inter-arrival times are not tracked.
+ */
+struct TimeoutDetector {
+	static void heartbeat(ArrivalWindow *window, long now) {}
+	static long suspectDeadline(PhiAccrualDetector *detector, ArrivalWindow *window, long timeout) {
+		return timeout;
+	}
+};
+
+/**
+ * STRUCT NAME: PhiDetector
+ *
+ * DESCRIPTION: Failure detector policy: phi-accrual over the heartbeat inter-arrival times,
+ * 				falling back to the fixed timeout until the window holds enough of them
+ */
+struct PhiDetector {
+	static void heartbeat(ArrivalWindow *window, long now) {
+		PhiAccrualDetector::heartbeat(window, now);
+	}
+	static long suspectDeadline(PhiAccrualDetector *detector, ArrivalWindow *window, long timeout) {
+		return detector->suspectDeadline(window, timeout);
+	}
+};
+
+/*
+ * Peer selection policies fill targets with the positions in the membership table a gossip
+ * round goes to. scratch is working space owned by the caller, so a round allocates nothing.
+ */
+
+/**
+ * STRUCT NAME: HalfWindowPeers
+ *
+ * DESCRIPTION: Peer selection policy: a window of half the table plus one, from a random start
+ */
+struct HalfWindowPeers {
+	static void select(MembershipTable *table, Params *par, int self, vector<int> &targets, vector<int> &scratch);
+};
+
+/**
+ * STRUCT NAME: RandomPeers
+ *
+ * DESCRIPTION: Peer selection policy: log2(N) + GOSSIP_RANDOM_EXTRA distinct random members
+ */
+struct RandomPeers {
+	static void select(MembershipTable *table, Params *par, int self, vector<int> &targets, vector<int> &scratch);
+};
+
+/**
+ * STRUCT NAME: ZonePeers
+ *
+ * DESCRIPTION: Peer selection policy: half of this node's zone, as HalfWindowPeers does for the
+ * 				whole group, and GOSSIP_CROSS_ZONE random members of other zones, which carry news
+ * 				between zones
+ */
+struct ZonePeers {
+	static void select(MembershipTable *table, Params *par, int self, vector<int> &targets, vector<int> &scratch);
+};
+
+/*
+ * Dissemination policies append the entries of a gossip message to buf. live holds the
+ * positions of the members that are not suspected, since is the tick of the previous round.
+ */
+
+/**
+ * STRUCT NAME: FullListGossip
+ *
+ * DESCRIPTION: Dissemination policy: every member that is not suspected
+ */
+struct FullListGossip {
+	static void putEntries(vector<char> &buf, long heartbeat, MembershipTable *table, vector<int> &live, int since);
+};
+
+/**
+ * STRUCT NAME: DeltaGossip
+ *
+ * DESCRIPTION: Dissemination policy: only the members refreshed since the previous round.
+ * 				Anything older has been pushed once already.
+ */
+struct DeltaGossip {
+	static void putEntries(vector<char> &buf, long heartbeat, MembershipTable *table, vector<int> &live, int since);
+};
+
+/**
+ * STRUCT NAME: PiggybackGossip
+ *
+ * DESCRIPTION: Dissemination policy: a random slice of the members rides along with the
+ * 				heartbeat. Every entry still reaches a peer every few rounds, which a fixed set
+ * 				of the freshest entries does not guarantee.
+ */
+struct PiggybackGossip {
+	static void putEntries(vector<char> &buf, long heartbeat, MembershipTable *table, vector<int> &live, int since);
+};
+
+#endif /* _MP1POLICIES_H_ */
@@ -5,22 +5,25 @@
  **********************************/
 #include "MP2Node.h"
 
-map<int, Message *> sentMessages;
-map<int, int> successReplies;
-map<int, int> failedReplies;
-map<int, long> readcounter;
-map<int, long> updatecounter;
+// Transaction Id shared by every node
+int g_transID = 0;
 
 /**
  * constructor
  */
-MP2Node::MP2Node(Member *memberNode, Params *par, EmulNet *emulNet, Log *log, Address *address) {
+MP2Node::MP2Node(Member *memberNode, Params *par, EmulNet *emulNet, Log *log, Address *address) : ring(par->REPLICAS, par), previousRing(par->REPLICAS, par) {
     this->memberNode = memberNode;
     this->par = par;
     this->emulNet = emulNet;
     this->log = log;
     ht = new HashTable();
     this->memberNode->addr = *address;
+    this->ringSubscriber = memberNode->memberEvents.subscribe();
+    this->ringEpoch = 0;
+    this->treeEpoch = -1;
+    this->antiEntropyCursor = 0;
+    this->outgoing = NULL;
+    this->replyFrames = NULL;
 }
 
 /**
@@ -35,89 +38,484 @@ MP2Node::~MP2Node() {
  * FUNCTION NAME: updateRing
  *
  * DESCRIPTION: This function does the following:
- * 				1) Gets the current membership list from the Membership Protocol (MP1Node)
- * 				   The membership list is returned as a vector of Nodes. See Node class in Node.h
+ * 				1) Gets the membership changes from the Membership Protocol (MP1Node)
+ * 				   The ring is built once from the membership list, then only the events
+ * 				   published since the last call are applied, so a tick without changes costs nothing
  * 				2) Constructs the ring based on the membership list
  * 				3) Calls the Stabilization Protocol
+ * 				4) Rebuilds the Merkle trees if the ring changed, and runs anti-entropy
+ * 				5) Hands hinted writes back to the replicas that recovered
  */
 void MP2Node::updateRing() {
-    /*
-     * Implement this. Parts of it are already implemented
-     */
-    vector<Node> curMemList;
+    MembershipEvent event;
     bool change_ring = false;
+    bool snapshot = false;
     /*
      *  Step 1. Get the current membership list from Membership Protocol / MP1
      */
-    curMemList = getMembershipList();
+    if (ring.empty()) {
+        vector<Node> members = getMembershipList();
+        ring.assign(members);
+        memberNode->memberEvents.skip(ringSubscriber);
+    }
 
     /*
      * Step 2: Construct the ring
      */
-    // Sort the list based on the hashCode
-    sort(curMemList.begin(), curMemList.end());
-    // if MemList changed, update ring
-    if (!sameRing(curMemList, ring)) {
-        log->LOG(&memberNode->addr, "update the ring");
-        ring = curMemList;
-        change_ring = true;
-        unsigned long pos = 0;
-        vector<Node>::iterator it;
-        for (it = ring.begin(); it != ring.end(); it++, pos++) {
-            if (it->nodeHashCode == myHashCode) {
-                haveReplicasOf.clear();
-                haveReplicasOf.push_back(ring.at((pos - 2 + ring.size()) % ring.size()));
-                haveReplicasOf.push_back(ring.at((pos - 1 + ring.size()) % ring.size()));
-                hasMyReplicas.clear();
-                hasMyReplicas.push_back(ring.at((pos + 1) % ring.size()));
-                hasMyReplicas.push_back(ring.at((pos + 2) % ring.size()));
-            }
+    while (memberNode->memberEvents.poll(ringSubscriber, &event)) {
+        if (!snapshot) {
+            // the ring as it was before this batch of changes, to diff against
+            previousRing = ring;
+            snapshot = true;
+        }
+        if (applyMembershipEvent(&event)) {
+            change_ring = true;
         }
     }
+    ringEpoch = memberNode->memberEvents.getEpoch();
 
     /*
      * Step 3: Run the stabilization protocol IF REQUIRED
      */
-    /**
-     * Run stabilization protocol if the hash table size is greater than zero and if there has been a changed in the ring
-     * DESCRIPTION: This runs the stabilization protocol in case of Node joins and leaves
-     * 				It ensures that there always 3 copies of all keys in the DHT at all times
-     * 				The function does the following:
-     *				1) Ensures that there are three "CORRECT" replicas of all the keys in spite of failures and joins
-     *				Note:- "CORRECT" replicas implies that every key is replicated in its two neighboring nodes in the ring
+    if (change_ring) {
+        log->LOG(&memberNode->addr, "update the ring");
+        if (!ht->isEmpty()) {
+            rebalance();
+        }
+    }
+
+    /*
+     * Step 4: Keep the Merkle trees on the current ranges, and compare one with a peer
+     */
+    if (ring.getEpoch() != treeEpoch) {
+        buildTrees();
+    }
+    antiEntropy();
+
+    /*
+     * Step 5: Hinted handoff
      */
-    if (ring.size() != 0 && change_ring && ht->hashTable.size() > 0) {
-        map<string, string>::iterator it;
-        for (it = ht->hashTable.begin(); it != ht->hashTable.end(); it++) {
-            Entry value = Entry(it->second);
-            if (value.replica == PRIMARY) {
-                Entry transValue1 = Entry(value.value, par->getcurrtime(), SECONDARY);
-                Entry transValue2 = Entry(value.value, par->getcurrtime(), TERTIARY);
-
-                Message message1 = Message(g_transID++, memberNode->addr, READREPLY, it->first, transValue1.convertToString());
-                Message message2 = Message(g_transID++, memberNode->addr, READREPLY, it->first, transValue2.convertToString());
-
-                emulNet->ENsend(&memberNode->addr, hasMyReplicas.at(0).getAddress(), (char *) &message1, sizeof(Message));
-                emulNet->ENsend(&memberNode->addr, hasMyReplicas.at(1).getAddress(), (char *) &message2, sizeof(Message));
-            } else if (value.replica == SECONDARY){
-                Entry transValue1 = Entry(value.value, par->getcurrtime(), PRIMARY);
-                Entry transValue2 = Entry(value.value, par->getcurrtime(), TERTIARY);
-
-                Message message1 = Message(g_transID++, memberNode->addr, READREPLY, it->first, transValue1.convertToString());
-                Message message2 = Message(g_transID++, memberNode->addr, READREPLY, it->first, transValue2.convertToString());
-
-                emulNet->ENsend(&memberNode->addr, haveReplicasOf.at(1).getAddress(), (char *) &message1, sizeof(Message));
-                emulNet->ENsend(&memberNode->addr, hasMyReplicas.at(0).getAddress(), (char *) &message2, sizeof(Message));
-            } else if (value.replica == TERTIARY) {
-                Entry transValue1 = Entry(value.value, par->getcurrtime(), PRIMARY);
-                Entry transValue2 = Entry(value.value, par->getcurrtime(), SECONDARY);
-
-                Message message1 = Message(g_transID++, memberNode->addr, READREPLY, it->first, transValue1.convertToString());
-                Message message2 = Message(g_transID++, memberNode->addr, READREPLY, it->first, transValue2.convertToString());
-
-                emulNet->ENsend(&memberNode->addr, haveReplicasOf.at(0).getAddress(), (char *) &message1, sizeof(Message));
-                emulNet->ENsend(&memberNode->addr, hasMyReplicas.at(1).getAddress(), (char *) &message2, sizeof(Message));
+    if (!hints.empty()) {
+        replayHints();
+    }
+}
+
+/**
+ * FUNCTION NAME: rebalance
+ *
+ * DESCRIPTION: Stabilization protocol. The token boundaries of the previous and the current
+ * 				ring split the ring into ranges that have one replica set in each. For every range
+ * 				this node held whose replica set changed, the first of its previous replicas that
+ * 				is still on the ring streams the keys of that range, and only those, to the
+ * 				replicas that were not in the previous set.
+ */
+void MP2Node::rebalance() {
+    vector<uint64_t> bounds;
+    vector<string> keys;
+
+    if (previousRing.empty() || ring.empty()) {
+        return;
+    }
+    for (size_t i = 0; i < previousRing.size(); i++) {
+        bounds.push_back(previousRing.at((int) i).getHashCode());
+    }
+    for (size_t i = 0; i < ring.size(); i++) {
+        bounds.push_back(ring.at((int) i).getHashCode());
+    }
+    sort(bounds.begin(), bounds.end());
+    bounds.erase(unique(bounds.begin(), bounds.end()), bounds.end());
+
+    for (size_t i = 0; i < bounds.size(); i++) {
+        // range (from, to], the first one wraps around the top of the ring
+        uint64_t from = bounds[(i + bounds.size() - 1) % bounds.size()];
+        uint64_t to = bounds[i];
+        vector<Node> &before = previousRing.replicasAt(previousRing.owner(to));
+        if (replicaPosition(before, &memberNode->addr) < 0) {
+            continue;
+        }
+        vector<Node> &after = ring.replicasAt(ring.owner(to));
+
+        // one sender per range: the first previous replica that did not leave
+        Address *sender = NULL;
+        for (size_t b = 0; b < before.size() && sender == NULL; b++) {
+            Node token = Node(*before[b].getAddress(), 0);
+            if (ring.find(token) >= 0) {
+                sender = before[b].getAddress();
+            }
+        }
+        if (sender == NULL || !sameAddress(sender, &memberNode->addr)) {
+            continue;
+        }
+
+        keys.clear();
+        for (size_t a = 0; a < after.size(); a++) {
+            if (replicaPosition(before, after[a].getAddress()) >= 0) {
+                continue;
+            }
+            if (keys.empty()) {
+                ht->keysInRange(from, to, keys);
+            }
+            for (size_t k = 0; k < keys.size(); k++) {
+                Entry entry = Entry(ht->read(keys[k]));
+                entry.replica = (ReplicaType) a;
+                Message message = Message(g_transID++, memberNode->addr, READREPLY, keys[k], entry.convertToString());
+                sendMessage(after[a].getAddress(), message);
+            }
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: replicaPosition
+ *
+ * DESCRIPTION: Position of the node with the given address in a replica set
+ *
+ * RETURNS:
+ * the position, -1 if the node is not a replica
+ */
+int MP2Node::replicaPosition(vector<Node> &replicas, Address *address) {
+    for (size_t i = 0; i < replicas.size(); i++) {
+        if (memcmp(replicas[i].getAddress()->addr, address->addr, sizeof(address->addr)) == 0) {
+            return (int) i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * FUNCTION NAME: buildTrees
+ *
+ * DESCRIPTION: One Merkle tree per token range (previous token, token] this node is a replica
+ * 				of, filled from the local keys of the range
+ */
+void MP2Node::buildTrees() {
+    vector<string> keys;
+
+    trees.clear();
+    antiEntropyCursor = 0;
+    treeEpoch = ring.getEpoch();
+    for (size_t i = 0; i < ring.size(); i++) {
+        if (replicaPosition(ring.replicasAt((int) i), &memberNode->addr) < 0) {
+            continue;
+        }
+        uint64_t from = ring.at((int) ((i + ring.size() - 1) % ring.size())).getHashCode();
+        uint64_t to = ring.at((int) i).getHashCode();
+        trees.push_back(MerkleTree(from, to));
+        keys.clear();
+        ht->keysInRange(from, to, keys);
+        for (size_t k = 0; k < keys.size(); k++) {
+            trees.back().add(hashFunction(keys[k]), itemHash(keys[k], ht->read(keys[k])));
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: treeOf
+ *
+ * DESCRIPTION: Tree of the range a ring position falls in. The trees are in ring order, so it
+ * 				is the first one ending at or after the position, or the one wrapping around.
+ *
+ * RETURNS:
+ * the tree, NULL if this node does not replicate the position
+ */
+MerkleTree *MP2Node::treeOf(uint64_t position) {
+    if (trees.empty()) {
+        return NULL;
+    }
+    size_t lo = 0, hi = trees.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (trees[mid].getTo() < position) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    MerkleTree *tree = &trees[lo % trees.size()];
+    return tree->covers(position) ? tree : NULL;
+}
+
+/**
+ * FUNCTION NAME: treeOf
+ *
+ * DESCRIPTION: Tree of the range "from,to" named by an anti-entropy message
+ *
+ * RETURNS:
+ * the tree, NULL if this node has no tree over exactly that range
+ */
+MerkleTree *MP2Node::treeOf(string range) {
+    size_t comma = range.find(',');
+    uint64_t from = stoull(range.substr(0, comma));
+    uint64_t to = stoull(range.substr(comma + 1));
+
+    for (size_t i = 0; i < trees.size(); i++) {
+        if (trees[i].getFrom() == from && trees[i].getTo() == to) {
+            return &trees[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * FUNCTION NAME: itemHash
+ *
+ * DESCRIPTION: Hash of a key and its stored entry as the trees see it. The replica field is
+ * 				left out, it differs between replicas holding the same value.
+ */
+uint64_t MP2Node::itemHash(string key, string stored) {
+    Entry entry = Entry(stored);
+    return Hash64::hash(key + '\0' + entry.value + '\0' + to_string(entry.timestamp));
+}
+
+/**
+ * FUNCTION NAME: updateTree
+ *
+ * DESCRIPTION: Follow a change of the local copy of a key, from before to what the table now
+ * 				holds, in the tree of its range
+ */
+void MP2Node::updateTree(string key, string before) {
+    uint64_t position = hashFunction(key);
+    MerkleTree *tree = treeOf(position);
+    if (tree == NULL) {
+        return;
+    }
+    string after = ht->read(key);
+    if (before.compare(after) == 0) {
+        return;
+    }
+    if (!before.empty()) {
+        tree->remove(position, itemHash(key, before));
+    }
+    if (!after.empty()) {
+        tree->add(position, itemHash(key, after));
+    }
+}
+
+/**
+ * FUNCTION NAME: antiEntropy
+ *
+ * DESCRIPTION: Every ANTI_ENTROPY_INTERVAL ticks, send the root of the next tree to the next
+ * 				other replica of its range. Nodes are spread over the interval by their id.
+ * 				Peers that agree exchange one message, otherwise the walk down to the differing
+ * 				leaves is driven by compareHashes.
+ */
+void MP2Node::antiEntropy() {
+    int id = *(int *) memberNode->addr.addr;
+    if (trees.empty() || (par->getcurrtime() + id) % ANTI_ENTROPY_INTERVAL != 0) {
+        return;
+    }
+    MerkleTree *tree = &trees[antiEntropyCursor % trees.size()];
+    vector<Node> &replicas = ring.replicasAt(ring.owner(tree->getTo()));
+    vector<Address *> peers;
+    for (size_t i = 0; i < replicas.size(); i++) {
+        if (!sameAddress(replicas[i].getAddress(), &memberNode->addr)) {
+            peers.push_back(replicas[i].getAddress());
+        }
+    }
+    // a full pass over the trees, then the next peer of each
+    size_t round = antiEntropyCursor++ / trees.size();
+    if (peers.empty()) {
+        return;
+    }
+    string range = to_string(tree->getFrom()) + "," + to_string(tree->getTo());
+    Message message = Message(g_transID++, memberNode->addr, MERKLE, range, "1/" + to_string(tree->hashAt(1)));
+    sendMessage(peers[round % peers.size()], message);
+}
+
+/**
+ * FUNCTION NAME: compareHashes
+ *
+ * DESCRIPTION: Handle a MERKLE message, node hashes of a peer's tree as "index/hash,...".
+ * 				Matching nodes end the walk there. The children of a differing inner node go
+ * 				back to the peer, which compares them in turn, and a differing leaf starts a
+ * 				key exchange.
+ */
+void MP2Node::compareHashes(Message *message) {
+    MerkleTree *tree = treeOf(message->key);
+    if (tree == NULL) {
+        // the peer's ring has other ranges, it will converge first
+        return;
+    }
+    string children;
+    size_t start = 0;
+    while (start < message->value.size()) {
+        size_t end = message->value.find(',', start);
+        if (end == string::npos) {
+            end = message->value.size();
+        }
+        string item = message->value.substr(start, end - start);
+        start = end + 1;
+
+        size_t slash = item.find('/');
+        int index = stoi(item.substr(0, slash));
+        if (tree->hashAt(index) == stoull(item.substr(slash + 1))) {
+            continue;
+        }
+        if (tree->isLeaf(index)) {
+            sendLeaf(&message->fromAddr, tree, index, false);
+            continue;
+        }
+        for (int child = 2 * index; child <= 2 * index + 1; child++) {
+            children += (children.empty() ? "" : ",") + to_string(child) + "/" + to_string(tree->hashAt(child));
+        }
+    }
+    if (!children.empty()) {
+        Message reply = Message(g_transID++, memberNode->addr, MERKLE, message->key, children);
+        sendMessage(&message->fromAddr, reply);
+    }
+}
+
+/**
+ * FUNCTION NAME: sendLeaf
+ *
+ * DESCRIPTION: Send the keys of one leaf as "key/timestamp/itemHash,..." in a MERKLELEAF
+ * 				message named "from,to,leaf,reply"
+ */
+void MP2Node::sendLeaf(Address *toAddr, MerkleTree *tree, int leaf, bool reply) {
+    vector<string> keys;
+    uint64_t lo, hi;
+    string items;
+
+    if (tree->leafRange(leaf, &lo, &hi)) {
+        ht->keysInRange(lo, hi, keys);
+    }
+    for (size_t k = 0; k < keys.size(); k++) {
+        string stored = ht->read(keys[k]);
+        items += (items.empty() ? "" : ",") + keys[k] + "/" + to_string(Entry(stored).timestamp) + "/" + to_string(itemHash(keys[k], stored));
+    }
+    string name = to_string(tree->getFrom()) + "," + to_string(tree->getTo()) + "," + to_string(leaf) + "," + (reply ? "1" : "0");
+    Message message = Message(g_transID++, memberNode->addr, MERKLELEAF, name, items);
+    sendMessage(toAddr, message);
+}
+
+/**
+ * FUNCTION NAME: compareLeaf
+ *
+ * DESCRIPTION: Handle a MERKLELEAF message. Every local key of the leaf the peer lacks, or
+ * 				holds an older version of, is pushed to it as a READREPLY. Versions of the same
+ * 				timestamp are ordered by item hash, so both sides settle on one. Unless the
+ * 				message was itself the answer, the local keys go back so the peer can do the same.
+ */
+void MP2Node::compareLeaf(Message *message) {
+    vector<string> fields;
+    size_t start = 0;
+    for (size_t end = message->key.find(','); end != string::npos; end = message->key.find(',', start)) {
+        fields.push_back(message->key.substr(start, end - start));
+        start = end + 1;
+    }
+    fields.push_back(message->key.substr(start));
+    if (fields.size() != 4) {
+        return;
+    }
+    MerkleTree *tree = treeOf(fields[0] + "," + fields[1]);
+    if (tree == NULL) {
+        return;
+    }
+    int leaf = stoi(fields[2]);
+
+    // the peer's versions, by key
+    map<string, pair<int, uint64_t> > theirs;
+    start = 0;
+    while (start < message->value.size()) {
+        size_t end = message->value.find(',', start);
+        if (end == string::npos) {
+            end = message->value.size();
+        }
+        string item = message->value.substr(start, end - start);
+        start = end + 1;
+
+        size_t second = item.rfind('/');
+        size_t first = item.rfind('/', second - 1);
+        theirs[item.substr(0, first)] = make_pair(stoi(item.substr(first + 1, second - first - 1)), (uint64_t) stoull(item.substr(second + 1)));
+    }
+
+    vector<string> keys;
+    uint64_t lo, hi;
+    if (tree->leafRange(leaf, &lo, &hi)) {
+        ht->keysInRange(lo, hi, keys);
+    }
+    for (size_t k = 0; k < keys.size(); k++) {
+        string stored = ht->read(keys[k]);
+        Entry entry = Entry(stored);
+        uint64_t hash = itemHash(keys[k], stored);
+        map<string, pair<int, uint64_t> >::iterator it = theirs.find(keys[k]);
+        if (it != theirs.end() && (it->second.first > entry.timestamp || (it->second.first == entry.timestamp && it->second.second >= hash))) {
+            continue;
+        }
+        int position = replicaPosition(ring.replicasAt(ring.owner(hashFunction(keys[k]))), &message->fromAddr);
+        if (position >= 0) {
+            entry.replica = (ReplicaType) position;
+        }
+        Message push = Message(g_transID++, memberNode->addr, READREPLY, keys[k], entry.convertToString());
+        sendMessage(&message->fromAddr, push);
+    }
+    if (fields[3] == "0") {
+        sendLeaf(&message->fromAddr, tree, leaf, true);
+    }
+}
+
+/**
+ * FUNCTION NAME: isSuspected
+ *
+ * DESCRIPTION: Whether the membership protocol suspects the node at address
+ */
+bool MP2Node::isSuspected(Address *address) {
+    return !suspects.empty() && suspects.count(*(int *) address->addr) > 0;
+}
+
+/**
+ * FUNCTION NAME: storeHint
+ *
+ * DESCRIPTION: Server side of a write meant for a suspected replica. The entry is kept apart
+ * 				from the local table, so it is not served to reads, until the replica is back.
+ * 				The write counts towards the coordinator's quorum.
+ */
+bool MP2Node::storeHint(Message *message) {
+    map<string, string> &held = hints[message->hint];
+    map<string, string>::iterator it = held.find(message->key);
+    if (it == held.end() || Entry(it->second).timestamp <= Entry(message->value).timestamp) {
+        held[message->key] = message->value;
+    }
+    if (message->type == CREATE) {
+        log->logCreateSuccess(&memberNode->addr, false, message->transID, message->key, message->value);
+    } else {
+        log->logUpdateSuccess(&memberNode->addr, false, message->transID, message->key, message->value);
+    }
+    Message reply = Message(message->transID, memberNode->addr, REPLY, true);
+    sendReply(message, reply);
+    return true;
+}
+
+/**
+ * FUNCTION NAME: replayHints
+ *
+ * DESCRIPTION: Hand the held writes of every replica that is no longer suspected back to it,
+ * 				HINT_BATCH a tick, as stabilization copies. The hints of a replica that has
+ * 				left the ring are dropped, its ranges moved to other nodes.
+ */
+void MP2Node::replayHints() {
+    map<string, map<string, string> >::iterator it = hints.begin();
+    while (it != hints.end()) {
+        Address target = Address(it->first);
+        if (isSuspected(&target)) {
+            it++;
+            continue;
+        }
+        Node token = Node(target, 0);
+        map<string, string> &held = it->second;
+        if (ring.find(token) >= 0) {
+            for (int sent = 0; sent < HINT_BATCH && !held.empty(); sent++) {
+                Message message = Message(g_transID++, memberNode->addr, READREPLY, held.begin()->first, held.begin()->second);
+                sendMessage(&target, message);
+                held.erase(held.begin());
             }
+        } else {
+            held.clear();
+        }
+        if (held.empty()) {
+            hints.erase(it++);
+        } else {
+            it++;
         }
     }
 }
@@ -137,8 +535,8 @@ vector<Node> MP2Node::getMembershipList() {
     vector<Node> curMemList;
     for (i = 0; i < this->memberNode->memberList.size(); i++) {
         Address addressOfThisMember;
-        int id = this->memberNode->memberList.at(i).getid();
-        short port = this->memberNode->memberList.at(i).getport();
+        int id = this->memberNode->memberList.getid(i);
+        short port = this->memberNode->memberList.getport(i);
         memcpy(&addressOfThisMember.addr[0], &id, sizeof(int));
         memcpy(&addressOfThisMember.addr[4], &port, sizeof(short));
         curMemList.emplace_back(Node(addressOfThisMember));
@@ -149,6 +547,37 @@ vector<Node> MP2Node::getMembershipList() {
     return curMemList;
 }
 
+/**
+ * FUNCTION NAME: applyMembershipEvent
+ *
+ * DESCRIPTION: Insert or remove the member named by the event at its place in the sorted ring.
+ * 				Suspicion does not move keys, the ring only follows joins and removals. A
+ * 				suspected member keeps its ranges, its writes go to a fallback node as hints.
+ *
+ * RETURNS:
+ * true if the ring changed
+ */
+bool MP2Node::applyMembershipEvent(MembershipEvent *event) {
+    Address address;
+    memcpy(&address.addr[0], &event->id, sizeof(int));
+    memcpy(&address.addr[4], &event->port, sizeof(short));
+    Node node = Node(address);
+
+    switch (event->type) {
+        case MEMBER_JOIN:
+            suspects.erase(event->id);
+            return ring.insert(node);
+        case MEMBER_SUSPECT:
+            suspects.insert(event->id);
+            return false;
+        case MEMBER_FAIL:
+        case MEMBER_REMOVE:
+            suspects.erase(event->id);
+            return ring.erase(node);
+    }
+    return false;
+}
+
 /**
  * FUNCTION NAME: hashFunction
  *
@@ -156,12 +585,10 @@ vector<Node> MP2Node::getMembershipList() {
  * 				HASH FUNCTION USED FOR CONSISTENT HASHING
  *
  * RETURNS:
- * size_t position on the ring
+ * position on the 64-bit ring
  */
-size_t MP2Node::hashFunction(string key) {
-    std::hash<string> hashFunc;
-    size_t ret = hashFunc(key);
-    return ret % RING_SIZE;
+uint64_t MP2Node::hashFunction(string key) {
+    return Hash64::hash(key);
 }
 
 /**
@@ -170,8 +597,8 @@ size_t MP2Node::hashFunction(string key) {
  * DESCRIPTION: client side CREATE API
  * 				The function does the following:
  */
-void MP2Node::clientCreate(string key, string value) {
-    buildClientMessages(key, value, CREATE);
+void MP2Node::clientCreate(string key, string value, ConsistencyLevel level) {
+    buildClientMessages(key, value, CREATE, level);
 }
 
 /**
@@ -180,8 +607,8 @@ void MP2Node::clientCreate(string key, string value) {
  * DESCRIPTION: client side READ API
  * 				The function does the following:
  */
-void MP2Node::clientRead(string key) {
-    buildClientMessages(key, "", READ);
+void MP2Node::clientRead(string key, ConsistencyLevel level) {
+    buildClientMessages(key, "", READ, level);
 }
 
 /**
@@ -189,8 +616,8 @@ void MP2Node::clientRead(string key) {
  *
  * DESCRIPTION: client side UPDATE API
  */
-void MP2Node::clientUpdate(string key, string value) {
-    buildClientMessages(key, value, UPDATE);
+void MP2Node::clientUpdate(string key, string value, ConsistencyLevel level) {
+    buildClientMessages(key, value, UPDATE, level);
 }
 
 /**
@@ -198,43 +625,133 @@ void MP2Node::clientUpdate(string key, string value) {
  *
  * DESCRIPTION: client side DELETE API
  */
-void MP2Node::clientDelete(string key) {
-    buildClientMessages(key, "", DELETE);
+void MP2Node::clientDelete(string key, ConsistencyLevel level) {
+    buildClientMessages(key, "", DELETE, level);
 }
 
-void MP2Node::buildClientMessages(string key, string value, MessageType type) {
+/**
+ * FUNCTION NAME: clientMultiGet
+ *
+ * DESCRIPTION: client side READ API for many keys. Each key is a request of its own, with its
+ * 				own quorum and log lines, but the requests bound for one node travel together.
+ */
+void MP2Node::clientMultiGet(vector<string> &keys, ConsistencyLevel level) {
+    map<string, vector<string> > frames;
+
+    outgoing = &frames;
+    for (size_t i = 0; i < keys.size(); i++) {
+        buildClientMessages(keys[i], "", READ, level);
+    }
+    outgoing = NULL;
+    sendBatches(frames);
+}
+
+/**
+ * FUNCTION NAME: clientMultiPut
+ *
+ * DESCRIPTION: client side CREATE API for many key value pairs, batched as clientMultiGet is
+ */
+void MP2Node::clientMultiPut(vector<pair<string, string> > &entries, ConsistencyLevel level) {
+    map<string, vector<string> > frames;
+
+    outgoing = &frames;
+    for (size_t i = 0; i < entries.size(); i++) {
+        buildClientMessages(entries[i].first, entries[i].second, CREATE, level);
+    }
+    outgoing = NULL;
+    sendBatches(frames);
+}
+
+/**
+ * FUNCTION NAME: sendBatches
+ *
+ * DESCRIPTION: Send the frames gathered for each node, as few BATCH messages of at most
+ * 				BATCH_FRAME_BYTES as they fit in. A lone frame goes as the plain message.
+ */
+void MP2Node::sendBatches(map<string, vector<string> > &frames) {
+    map<string, vector<string> >::iterator it;
+    for (it = frames.begin(); it != frames.end(); it++) {
+        Address toAddr = Address(it->first);
+        vector<string> &queued = it->second;
+        if (queued.empty()) {
+            continue;
+        }
+        if (queued.size() == 1) {
+            Message single = Message(queued[0]);
+            sendMessage(&toAddr, single);
+            continue;
+        }
+        Message batch = Message(g_transID++, memberNode->addr, BATCH, "", "");
+        for (size_t i = 0; i < queued.size(); i++) {
+            if (!batch.value.empty() && batch.value.size() + queued[i].size() > BATCH_FRAME_BYTES) {
+                sendMessage(&toAddr, batch);
+                batch.value.clear();
+            }
+            Message::appendFrame(batch.value, queued[i]);
+        }
+        sendMessage(&toAddr, batch);
+    }
+}
+
+/**
+ * FUNCTION NAME: buildClientMessages
+ *
+ * DESCRIPTION: Coordinator side of a client request: send it to every replica of the key and
+ * 				record how many replies it needs. QUORUM means READ_QUORUM for reads and
+ * 				WRITE_QUORUM for writes.
+ */
+void MP2Node::buildClientMessages(string key, string value, MessageType type, ConsistencyLevel level) {
     //1.Constructs the message
     int transID = g_transID++;
     Message message = Message(transID, memberNode->addr, type, key);
-    successReplies[transID] = 0;
-    failedReplies[transID] = 0;
-    if (type == READ) {
-        readcounter[transID] = par->getcurrtime();
-    }
-    if (type == UPDATE) {
-        updatecounter[transID] = par->getcurrtime();
-    }
 
-    //2.Finds the replicas of this key
+    //2.Finds the replicas of this key, and starts tracking the request
     vector<Node> replicas = findNodes(key);
+    PendingRequest *request = pending.open(transID, type, key, par->getcurrtime() + PENDING_TIMEOUT + 1);
+    request->quorum = type == READ ? par->READ_QUORUM : par->WRITE_QUORUM;
+    if (level == ONE) {
+        request->quorum = 1;
+    } else if (level == ALL) {
+        request->quorum = (int) replicas.size();
+    }
+    request->replicas = (int) replicas.size();
+
+    //3.Finds the fallback nodes of a write: the healthy nodes after the replicas, in ring order
+    vector<Node> fallbacks;
+    size_t nextFallback = replicas.size();
+    if (type == CREATE || type == UPDATE) {
+        for (size_t i = 0; i < replicas.size() && fallbacks.empty(); i++) {
+            if (isSuspected(replicas[i].getAddress())) {
+                ring.walk(ring.owner(hashFunction(key)), 1, (int) ring.size(), fallbacks);
+            }
+        }
+    }
 
-    //3.Sends a message to the replica
+    //4.Sends a message to the replica, or to a fallback node if the replica is suspected
     vector<Node>::iterator it;
     for (it = replicas.begin(); it != replicas.end(); it++) {
-        if (it->getHashCode() == this->myHashCode) {
-            // if it's local, call local function
-            ReplicaType replicaType;
-            if (myHashCode == replicas.at(0).getHashCode()) {
-                replicaType = PRIMARY;
-            } else if (myHashCode == replicas.at(1).getHashCode()) {
-                replicaType = SECONDARY;
-            } else {
-                replicaType = TERTIARY;
+        // replicas are distinct physical nodes in ring order, the position is the replica type
+        ReplicaType replicaType = (ReplicaType) (it - replicas.begin());
+        Address *target = it->getAddress();
+        message.hint.clear();
+        if (!fallbacks.empty() && isSuspected(target)) {
+            while (nextFallback < fallbacks.size() && isSuspected(fallbacks[nextFallback].getAddress())) {
+                nextFallback++;
+            }
+            if (nextFallback < fallbacks.size()) {
+                message.hint = target->getAddress();
+                target = fallbacks[nextFallback++].getAddress();
             }
-            Entry *entryValue = new Entry(value, par->getcurrtime(), replicaType);
-            message.replica = replicaType;
-            message.value = entryValue->convertToString();
-            sentMessages[transID] = new Message(message);
+        }
+        message.replica = replicaType;
+        message.value = Entry(value, par->getcurrtime(), replicaType).convertToString();
+        // a local replica may already have decided the request
+        request = pending.find(transID);
+        if (request != NULL) {
+            request->value = message.value;
+        }
+        if (sameAddress(target, &memberNode->addr)) {
+            // if it's local, call local function
             switch (type) {
                 case CREATE: {
                     createKeyValue(&message);
@@ -255,24 +772,49 @@ void MP2Node::buildClientMessages(string key, string value, MessageType type) {
                 default:
                     break;
             }
+        } else if (outgoing != NULL) {
+            (*outgoing)[target->getAddress()].push_back(message.toString());
         } else {
-            ReplicaType replicaType;
-            if (it->getHashCode() == replicas.at(0).getHashCode()) {
-                replicaType = PRIMARY;
-            } else if (it->getHashCode() == replicas.at(1).getHashCode()) {
-                replicaType = SECONDARY;
-            } else {
-                replicaType = TERTIARY;
-            }
-            Entry *entryValue = new Entry(value, par->getcurrtime(), replicaType);
-            message.replica = replicaType;
-            message.value = entryValue->convertToString();
-            sentMessages[transID] = new Message(message);
-            emulNet->ENsend(&memberNode->addr, it->getAddress(), (char *) &message, sizeof(Message));
+            sendMessage(target, message);
         }
     }
 }
 
+/**
+ * FUNCTION NAME: sendReply
+ *
+ * DESCRIPTION: Server side: answer a request, locally if this node coordinates it. The replies
+ * 				to the requests of a batch are gathered and go back as one batch.
+ */
+void MP2Node::sendReply(Message *request, Message &reply) {
+    if (sameAddress(&memberNode->addr, &request->fromAddr)) {
+        // if it's local, call local function
+        handleReply(&reply);
+    } else if (replyFrames != NULL) {
+        replyFrames->push_back(reply.toString());
+    } else {
+        sendMessage(&request->fromAddr, reply);
+    }
+}
+
+/**
+ * FUNCTION NAME: handleBatch
+ *
+ * DESCRIPTION: Handle every message of a BATCH in order, and send their replies back together
+ */
+void MP2Node::handleBatch(Message *message) {
+    vector<string> frames;
+    map<string, vector<string> > replies;
+
+    Message::splitFrames(message->value, frames);
+    replyFrames = &replies[message->fromAddr.getAddress()];
+    for (size_t i = 0; i < frames.size(); i++) {
+        dispatchMessages(Message(frames[i]));
+    }
+    replyFrames = NULL;
+    sendBatches(replies);
+}
+
 /**
  * FUNCTION NAME: createKeyValue
  *
@@ -282,8 +824,13 @@ void MP2Node::buildClientMessages(string key, string value, MessageType type) {
  * 			   	2) Return true or false based on success or failure
  */
 bool MP2Node::createKeyValue(Message *message) {
+    if (!message->hint.empty()) {
+        return storeHint(message);
+    }
     //do create
+    string before = ht->read(message->key);
     bool result = ht->create(message->key, message->value);
+    updateTree(message->key, before);
     //log the result
     if (result) {
         log->logCreateSuccess(&memberNode->addr, false, message->transID, message->key, message->value);
@@ -292,12 +839,7 @@ bool MP2Node::createKeyValue(Message *message) {
     }
     //construct a reply and send it
     Message reply = Message(message->transID, memberNode->addr, REPLY, result);
-    if (sameAddress(&memberNode->addr, &message->fromAddr)) {
-        // if it's local, call local function
-        handleReply(&reply);
-    } else {
-        emulNet->ENsend(&memberNode->addr, &message->fromAddr, (char *) &reply, sizeof(Message));
-    }
+    sendReply(message, reply);
     return result;
 }
 
@@ -320,12 +862,8 @@ string MP2Node::readKey(Message *message) {
     }
     //construct a reply and send it
     Message reply = Message(message->transID, memberNode->addr, REPLY, message->key, value);
-    if (sameAddress(&memberNode->addr, &message->fromAddr)) {
-        // if it's local, call local function
-        handleReply(&reply);
-    } else {
-        emulNet->ENsend(&memberNode->addr, &message->fromAddr, (char *) &reply, sizeof(Message));
-    }
+    reply.success = !value.empty();
+    sendReply(message, reply);
     return value;
 }
 
@@ -338,8 +876,13 @@ string MP2Node::readKey(Message *message) {
  * 				2) Return true or false based on success or failure
  */
 bool MP2Node::updateKeyValue(Message *message) {
+    if (!message->hint.empty()) {
+        return storeHint(message);
+    }
     //do update
+    string before = ht->read(message->key);
     bool result = ht->update(message->key, message->value);
+    updateTree(message->key, before);
     //log the result
     if (result) {
         log->logUpdateSuccess(&memberNode->addr, false, message->transID, message->key, message->value);
@@ -348,32 +891,33 @@ bool MP2Node::updateKeyValue(Message *message) {
     }
     //construct a reply and send it
     Message reply = Message(message->transID, memberNode->addr, REPLY, result);
-    if (sameAddress(&memberNode->addr, &message->fromAddr)) {
-        // if it's local, call local function
-        handleReply(&reply);
-    } else {
-        emulNet->ENsend(&memberNode->addr, &message->fromAddr, (char *) &reply, sizeof(Message));
-    }
+    sendReply(message, reply);
+    return result;
 }
 
+/**
+ * FUNCTION NAME: stabilization
+ *
+ * DESCRIPTION: Store a copy pushed by another replica, by the stabilization protocol or by
+ * 				anti-entropy. An older copy than the local one is dropped.
+ */
 bool MP2Node::stabilization(Message *message) {
-    //just do update
     bool result = false;
     string v = ht->read(message->key);
     if (v.empty()) {
-        ht->create(message->key, message->value);
+        result = ht->create(message->key, message->value);
     } else {
         if (v.compare(message->value) == 0) {
             return result;
-        } else {
-            result = ht->update(message->key, message->value);
-//            if (result) {
-//                log->logUpdateSuccess(&memberNode->addr, false, message->transID, message->key, message->value + "-stabilization");
-//            } else {
-//                log->logUpdateFail(&memberNode->addr, false, message->transID, message->key, message->value + "-stabilization");
-//            }
         }
+        Entry local = Entry(v);
+        Entry pushed = Entry(message->value);
+        if (pushed.timestamp < local.timestamp || (pushed.timestamp == local.timestamp && itemHash(message->key, message->value) < itemHash(message->key, v))) {
+            return result;
+        }
+        result = ht->update(message->key, message->value);
     }
+    updateTree(message->key, v);
     return result;
 }
 
@@ -387,7 +931,9 @@ bool MP2Node::stabilization(Message *message) {
  */
 bool MP2Node::deletekey(Message *message) {
     //do delete
+    string before = ht->read(message->key);
     bool result = ht->deleteKey(message->key);
+    updateTree(message->key, before);
     //log the result
     if (result) {
         log->logDeleteSuccess(&memberNode->addr, false, message->transID, message->key);
@@ -396,89 +942,155 @@ bool MP2Node::deletekey(Message *message) {
     }
     //construct a reply and send it
     Message reply = Message(message->transID, memberNode->addr, REPLY, result);
-    if (sameAddress(&memberNode->addr, &message->fromAddr)) {
-        // if it's local, call local function
-        handleReply(&reply);
-    } else {
-        emulNet->ENsend(&memberNode->addr, &message->fromAddr, (char *) &reply, sizeof(Message));
-    }
+    sendReply(message, reply);
+    return result;
 }
 
+/**
+ * FUNCTION NAME: handleReply
+ *
+ * DESCRIPTION: Coordinator side: count a replica's reply. The request succeeds once its quorum
+ * 				of replies succeeded, and fails once too many failed for the rest to make the
+ * 				quorum. Either way it is logged once and closed, except a read: it keeps the copy
+ * 				of every replica, returns the newest one it has when it is decided, and stays
+ * 				open to repair the stale replicas once all of them answered.
+ */
 bool MP2Node::handleReply(Message *message) {
-    Message *msgSent = sentMessages[message->transID];
-    switch (msgSent->type) {
+    PendingRequest *request = pending.find(message->transID);
+    if (request == NULL) {
+        // closed already
+        return false;
+    }
+    if (request->type == READ) {
+        request->versions.push_back(make_pair(message->fromAddr, message->value));
+    }
+    if (request->decided) {
+        if ((int) request->versions.size() == request->replicas) {
+            repairRead(request);
+        }
+        return false;
+    }
+    bool success = request->type == READ ? message->value.compare("") != 0 : message->success;
+    int replies = success ? ++request->successes : ++request->failures;
+    int needed = success ? request->quorum : request->replicas - request->quorum + 1;
+    if (replies < needed) {
+        return false;
+    }
+
+    logResult(request, success);
+    request->decided = true;
+    if (request->type != READ) {
+        pending.close(request);
+    } else if ((int) request->versions.size() == request->replicas) {
+        repairRead(request);
+    }
+    return true;
+}
+
+/**
+ * FUNCTION NAME: logResult
+ *
+ * DESCRIPTION: Log the outcome of a request at the coordinator
+ */
+void MP2Node::logResult(PendingRequest *request, bool success) {
+    Address *coordinator = &memberNode->addr;
+    switch (request->type) {
         case CREATE: {
-            if (message->success) {
-                successReplies[message->transID]++;
-                if (successReplies[message->transID] > 1) {
-                    log->logCreateSuccess(&msgSent->fromAddr, true, msgSent->transID, msgSent->key, msgSent->value);
-                    successReplies[message->transID] = 0;
-                }
+            if (success) {
+                log->logCreateSuccess(coordinator, true, request->transID, request->key, request->value);
             } else {
-                failedReplies[message->transID]++;
-                if (failedReplies[message->transID] > 1) {
-                    log->logCreateFail(&msgSent->fromAddr, true, msgSent->transID, msgSent->key, msgSent->value);
-                    failedReplies[message->transID] = 0;
-                }
+                log->logCreateFail(coordinator, true, request->transID, request->key, request->value);
             }
             break;
         }
         case DELETE: {
-            if (message->success) {
-                successReplies[message->transID]++;
-                if (successReplies[message->transID] > 1) {
-                    log->logDeleteSuccess(&msgSent->fromAddr, true, msgSent->transID, msgSent->key);
-                    successReplies[message->transID] = 0;
-                }
+            if (success) {
+                log->logDeleteSuccess(coordinator, true, request->transID, request->key);
             } else {
-                failedReplies[message->transID]++;
-                if (failedReplies[message->transID] > 1) {
-                    log->logDeleteFail(&msgSent->fromAddr, true, msgSent->transID, msgSent->key);
-                    failedReplies[message->transID] = 0;
-                }
+                log->logDeleteFail(coordinator, true, request->transID, request->key);
             }
             break;
         }
         case READ: {
-            if (message->value.compare("") != 0) {
-                successReplies[message->transID]++;
-                if (successReplies[message->transID] > 1) {
-                    log->logReadSuccess(&msgSent->fromAddr, true, msgSent->transID, msgSent->key, message->value);
-                    successReplies[message->transID] = 0;
-                    readcounter.erase(message->transID);
-                }
+            if (success) {
+                log->logReadSuccess(coordinator, true, request->transID, request->key, newestVersion(request->key, request->versions));
             } else {
-                failedReplies[message->transID]++;
-                if (failedReplies[message->transID] > 1) {
-                    log->logReadFail(&msgSent->fromAddr, true, msgSent->transID, msgSent->key);
-                    failedReplies[message->transID] = 0;
-                    readcounter.erase(message->transID);
-                }
+                log->logReadFail(coordinator, true, request->transID, request->key);
             }
             break;
         }
         case UPDATE: {
-            if (message->success) {
-                successReplies[message->transID]++;
-                if (successReplies[message->transID] > 1) {
-                    log->logUpdateSuccess(&msgSent->fromAddr, true, msgSent->transID, msgSent->key, msgSent->value);
-                    successReplies[message->transID] = 0;
-                    updatecounter.erase(message->transID);
-                }
+            if (success) {
+                log->logUpdateSuccess(coordinator, true, request->transID, request->key, request->value);
             } else {
-                failedReplies[message->transID]++;
-                if (failedReplies[message->transID] > 1) {
-                    log->logUpdateFail(&msgSent->fromAddr, true, msgSent->transID, msgSent->key, msgSent->value);
-                    failedReplies[message->transID] = 0;
-                    updatecounter.erase(message->transID);
-                }
+                log->logUpdateFail(coordinator, true, request->transID, request->key, request->value);
             }
             break;
         }
         default:
             break;
     }
-    return false;
+}
+
+/**
+ * FUNCTION NAME: newestVersion
+ *
+ * DESCRIPTION: The newest of the copies returned by the replicas. Copies of the same timestamp
+ * 				are ordered by item hash, as stabilization orders them.
+ *
+ * RETURNS:
+ * the stored entry, empty if no replica had the key
+ */
+string MP2Node::newestVersion(string key, vector<pair<Address, string> > &versions) {
+    string newest;
+    for (size_t i = 0; i < versions.size(); i++) {
+        string &stored = versions[i].second;
+        if (stored.empty()) {
+            continue;
+        }
+        if (newest.empty() || Entry(stored).timestamp > Entry(newest).timestamp) {
+            newest = stored;
+        } else if (Entry(stored).timestamp == Entry(newest).timestamp && itemHash(key, stored) > itemHash(key, newest)) {
+            newest = stored;
+        }
+    }
+    return newest;
+}
+
+/**
+ * FUNCTION NAME: repairRead
+ *
+ * DESCRIPTION: Read repair. Push the newest copy a read saw to every replica that answered
+ * 				with an older copy or none, then close the read.
+ */
+void MP2Node::repairRead(PendingRequest *request) {
+    vector<pair<Address, string> > &versions = request->versions;
+    string key = request->key;
+    string newest = newestVersion(key, versions);
+
+    if (!newest.empty()) {
+        vector<Node> replicas = findNodes(key);
+        Entry entry = Entry(newest);
+        uint64_t hash = itemHash(key, newest);
+        for (size_t i = 0; i < versions.size(); i++) {
+            string &stored = versions[i].second;
+            if (!stored.empty() && (Entry(stored).timestamp > entry.timestamp || itemHash(key, stored) == hash)) {
+                continue;
+            }
+            Address *replica = &versions[i].first;
+            int position = replicaPosition(replicas, replica);
+            if (position >= 0) {
+                entry.replica = (ReplicaType) position;
+            }
+            Message repair = Message(g_transID++, memberNode->addr, READREPLY, key, entry.convertToString());
+            if (sameAddress(replica, &memberNode->addr)) {
+                stabilization(&repair);
+            } else {
+                sendMessage(replica, repair);
+            }
+        }
+    }
+    pending.close(request);
 }
 
 /**
@@ -513,37 +1125,8 @@ void MP2Node::checkMessages() {
          * Handle the message types here
          */
 //        Message *msg_try = new Message(message_o);
-        Message *message;
-        message = (Message *) malloc(sizeof(Message));
-        memcpy(message, data, sizeof(Message));
-        switch (message->type) {
-            case CREATE: {
-                createKeyValue(message);
-                break;
-            }
-            case UPDATE: {
-                updateKeyValue(message);
-                break;
-            }
-            case DELETE: {
-                deletekey(message);
-                break;
-            }
-            case READ: {
-                readKey(message);
-                break;
-            }
-            case REPLY: {
-                handleReply(message);
-                break;
-            }
-            case READREPLY: {
-                stabilization(message);
-                break;
-            }
-            default:
-                break;
-        }
+        dispatchMessages(Message(string(data, size)));
+        emulNet->ENrelease(data);
     }
 
     /*
@@ -552,26 +1135,82 @@ void MP2Node::checkMessages() {
      */
 }
 
-void MP2Node::checkReadResult() {
-    if (readcounter.empty() && updatecounter.empty()) return;
-    map<int, long>::iterator it;
-    for (it = readcounter.begin(); it != readcounter.end(); it++) {
-        if (par->getcurrtime() - it->second > 10) {
-            Message *msg = sentMessages[it->first];
-            log->logReadFail(&msg->fromAddr, true, msg->transID, msg->key);
-            readcounter.erase(it->first);
-            return;
+/**
+ * FUNCTION NAME: dispatchMessages
+ *
+ * DESCRIPTION: Handle one message according to its type
+ */
+void MP2Node::dispatchMessages(Message parsed) {
+    Message *message = &parsed;
+    switch (message->type) {
+        case CREATE: {
+            createKeyValue(message);
+            break;
         }
+        case UPDATE: {
+            updateKeyValue(message);
+            break;
+        }
+        case DELETE: {
+            deletekey(message);
+            break;
+        }
+        case READ: {
+            readKey(message);
+            break;
+        }
+        case REPLY: {
+            handleReply(message);
+            break;
+        }
+        case READREPLY: {
+            stabilization(message);
+            break;
+        }
+        case MERKLE: {
+            compareHashes(message);
+            break;
+        }
+        case MERKLELEAF: {
+            compareLeaf(message);
+            break;
+        }
+        case BATCH: {
+            handleBatch(message);
+            break;
+        }
+        default:
+            break;
     }
+}
 
-    map<int, long>::iterator it2;
-    for (it = updatecounter.begin(); it != updatecounter.end(); it++) {
-        if (par->getcurrtime() - it->second > 10) {
-            Message *msg = sentMessages[it->first];
-            log->logUpdateFail(&msg->fromAddr, true, msg->transID, msg->key, msg->value);
-            updatecounter.erase(it->first);
-            return;
-        }
+/**
+ * FUNCTION NAME: expireRequests
+ *
+ * DESCRIPTION: Fail every request whose replies did not make its quorum in time, and repair
+ * 				from what came the reads that were waiting for their last replies
+ */
+void MP2Node::expireRequests() {
+    pending.expire(par->getcurrtime(), expireRequestWrapper, this);
+}
+
+/**
+ * FUNCTION NAME: expireRequestWrapper
+ *
+ * DESCRIPTION: Timer wheel callback, the owner of the timer is the slot of the request
+ */
+void MP2Node::expireRequestWrapper(void *env, int timer, int slot) {
+    MP2Node *node = (MP2Node *) env;
+    PendingRequest *request = node->pending.at(slot);
+
+    if (!request->decided) {
+        node->logResult(request, false);
+        request->decided = true;
+    }
+    if (request->type == READ) {
+        node->repairRead(request);
+    } else {
+        node->pending.close(request);
     }
 }
 
@@ -579,32 +1218,30 @@ void MP2Node::checkReadResult() {
 /**
  * FUNCTION NAME: findNodes
  *
- * DESCRIPTION: Find the replicas of the given keyfunction
- * 				This function is responsible for finding the replicas of a key
+ * DESCRIPTION: Find the replicas of the given key: the first node clockwise from its hash,
+ * 				found by binary search, and the nodes after it. The set is cached by the ring
+ * 				until the next membership change.
  */
 vector<Node> MP2Node::findNodes(string key) {
-    size_t pos = hashFunction(key);
-    vector<Node> addr_vec;
-    if (ring.size() >= 3) {
-        // if pos <= min || pos > max, the leader is the min
-        if (pos <= ring.at(0).getHashCode() || pos > ring.at(ring.size() - 1).getHashCode()) {
-            addr_vec.emplace_back(ring.at(0));
-            addr_vec.emplace_back(ring.at(1));
-            addr_vec.emplace_back(ring.at(2));
-        } else {
-            // go through the ring until pos <= node
-            for (int i = 1; i < ring.size(); i++) {
-                Node addr = ring.at(i);
-                if (pos <= addr.getHashCode()) {
-                    addr_vec.emplace_back(addr);
-                    addr_vec.emplace_back(ring.at((i + 1) % ring.size()));
-                    addr_vec.emplace_back(ring.at((i + 2) % ring.size()));
-                    break;
-                }
-            }
-        }
+    if (ring.empty()) {
+        return vector<Node>();
+    }
+    vector<Node> &replicas = ring.replicasAt(ring.owner(hashFunction(key)));
+    if ((int) replicas.size() < par->REPLICAS) {
+        return vector<Node>();
     }
-    return addr_vec;
+    return replicas;
+}
+
+/**
+ * FUNCTION NAME: sendMessage
+ *
+ * DESCRIPTION: Send a message in its string form. A Message holds std::strings, so its
+ * 				bytes cannot be copied to another node as they are.
+ */
+void MP2Node::sendMessage(Address *toAddr, Message &message) {
+    string wire = message.toString();
+    emulNet->ENsend(&memberNode->addr, toAddr, (char *) wire.data(), (int) wire.size());
 }
 
 /**
@@ -616,7 +1253,7 @@ bool MP2Node::recvLoop() {
     if (memberNode->bFailed) {
         return false;
     } else {
-        checkReadResult();
+        expireRequests();
         return emulNet->ENrecv(&(memberNode->addr), this->enqueueWrapper, NULL, 1, &(memberNode->mp2q));
     }
 }
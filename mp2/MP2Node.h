@@ -19,6 +19,19 @@
 #include "Params.h"
 #include "Message.h"
 #include "Queue.h"
+#include "Ring.h"
+#include "MerkleTree.h"
+#include "PendingTable.h"
+
+/**
+ * Macros
+ */
+// ticks between two anti-entropy rounds of a node
+#define ANTI_ENTROPY_INTERVAL 10
+// hinted writes a fallback node hands back to one recovered replica per tick
+#define HINT_BATCH 16
+// largest value of a BATCH message, below the network's MAX_MSG_SIZE
+#define BATCH_FRAME_BYTES 3000
 
 ///**
 // * STRUCT NAME: MessageHdr
@@ -44,14 +57,18 @@
  */
 class MP2Node {
 private:
-	// Vector holding the next two neighbors in the ring who have my replicas
-	vector<Node> hasMyReplicas;
-	// Vector holding the previous two neighbors in the ring whose replicas I have
-	vector<Node> haveReplicasOf;
 	// Ring
-	vector<Node> ring;
+	Ring ring;
+	// Ring before the latest batch of membership changes
+	Ring previousRing;
+	// Cursor of the ring on the membership event stream
+	int ringSubscriber;
+	// Membership epoch the ring reflects
+	long ringEpoch;
 	// Hash Table
 	HashTable * ht;
+	// Client requests this node coordinates
+	PendingTable pending;
 	// Member representing this member
 	Member *memberNode;
 	// Params object
@@ -61,7 +78,21 @@ private:
 	// Object of Log
 	Log * log;
     // Node HashCode
-    size_t myHashCode;
+    uint64_t myHashCode;
+	// Merkle tree of each range this node replicates, in ring order
+	vector<MerkleTree> trees;
+	// Ring epoch the trees were built for
+	long treeEpoch;
+	// Next tree to compare with a peer
+	size_t antiEntropyCursor;
+	// Ids of the members the membership protocol currently suspects
+	set<int> suspects;
+	// Writes held for a suspected replica, by its address and then by key
+	map<string, map<string, string> > hints;
+	// While a multi-key request is built, the messages for each node, by address
+	map<string, vector<string> > *outgoing;
+	// While a batch is handled, the replies to its messages
+	vector<string> *replyFrames;
 
 public:
 	MP2Node(Member *memberNode, Params *par, EmulNet *emulNet, Log *log, Address *addressOfMember);
@@ -72,15 +103,38 @@ public:
 	// ring functionalities
 	void updateRing();
 	vector<Node> getMembershipList();
-	size_t hashFunction(string key);
-	void findNeighbors();
+	bool applyMembershipEvent(MembershipEvent *event);
+	uint64_t hashFunction(string key);
+	void rebalance();
+	int replicaPosition(vector<Node> &replicas, Address *address);
+
+	// anti-entropy
+	void buildTrees();
+	MerkleTree *treeOf(uint64_t position);
+	MerkleTree *treeOf(string range);
+	uint64_t itemHash(string key, string stored);
+	void updateTree(string key, string before);
+	void antiEntropy();
+	void compareHashes(Message *message);
+	void compareLeaf(Message *message);
+	void sendLeaf(Address *toAddr, MerkleTree *tree, int leaf, bool reply);
+
+	// hinted handoff
+	bool isSuspected(Address *address);
+	bool storeHint(Message *message);
+	void replayHints();
 
 	// client side CRUD APIs
-	void clientCreate(string key, string value);
-	void clientRead(string key);
-	void clientUpdate(string key, string value);
-	void clientDelete(string key);
-    void buildClientMessages(string key, string value, MessageType type);
+	void clientCreate(string key, string value, ConsistencyLevel level = QUORUM);
+	void clientRead(string key, ConsistencyLevel level = QUORUM);
+	void clientUpdate(string key, string value, ConsistencyLevel level = QUORUM);
+	void clientDelete(string key, ConsistencyLevel level = QUORUM);
+    void buildClientMessages(string key, string value, MessageType type, ConsistencyLevel level);
+	void clientMultiGet(vector<string> &keys, ConsistencyLevel level = QUORUM);
+	void clientMultiPut(vector<pair<string, string> > &entries, ConsistencyLevel level = QUORUM);
+	void sendBatches(map<string, vector<string> > &frames);
+
+	void sendMessage(Address *toAddr, Message &message);
 
 	// receive messages from Emulnet
 	bool recvLoop();
@@ -88,7 +142,8 @@ public:
 
 	// handle messages from receiving queue
 	void checkMessages();
-    void checkReadResult();
+    void expireRequests();
+    static void expireRequestWrapper(void *env, int timer, int slot);
 
 	// coordinator dispatches messages to corresponding nodes
 	void dispatchMessages(Message message);
@@ -102,7 +157,12 @@ public:
 	bool updateKeyValue(Message *message);
 	bool deletekey(Message *message);
     bool handleReply(Message *message);
+    void sendReply(Message *request, Message &reply);
+    void handleBatch(Message *message);
+    void logResult(PendingRequest *request, bool success);
     bool stabilization(Message *message);
+    string newestVersion(string key, vector<pair<Address, string> > &versions);
+    void repairRead(PendingRequest *request);
 
 	// stabilization protocol - handle multiple failures
 //    void stabilizationProtocol(bool change_prev, bool change_next);
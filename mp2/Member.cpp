@@ -152,6 +152,7 @@ Member::Member(const Member &anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
+	this->memberEvents = anotherMember.memberEvents;
 	this->myPos = anotherMember.myPos;
 	this->mp1q = anotherMember.mp1q;
 	this->mp2q = anotherMember.mp2q;
@@ -170,6 +171,7 @@ Member& Member::operator =(const Member& anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
+	this->memberEvents = anotherMember.memberEvents;
 	this->myPos = anotherMember.myPos;
 	this->mp1q = anotherMember.mp1q;
 	this->mp2q = anotherMember.mp2q;
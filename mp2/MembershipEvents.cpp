@@ -0,0 +1,78 @@
+/**********************************
+ * FILE NAME: MembershipEvents.cpp
+ *
+ * DESCRIPTION: Definition of the membership change event stream
+ **********************************/
+
+#include "MembershipEvents.h"
+
+/**
+ * FUNCTION NAME: publish
+ *
+ * DESCRIPTION: Append an event under the next epoch
+ */
+void MembershipEventLog::publish(int type, int id, short port) {
+	epoch++;
+	if (cursors.empty()) {
+		return;
+	}
+	MembershipEvent event = {epoch, type, id, port};
+	events.push_back(event);
+}
+
+/**
+ * FUNCTION NAME: subscribe
+ *
+ * DESCRIPTION: Register a subscriber. It sees the events published from now on.
+ *
+ * RETURNS:
+ * handle of the subscriber
+ */
+int MembershipEventLog::subscribe() {
+	cursors.push_back(epoch + 1);
+	return (int) cursors.size() - 1;
+}
+
+/**
+ * FUNCTION NAME: poll
+ *
+ * DESCRIPTION: Read the next event of a subscriber
+ *
+ * RETURNS:
+ * false once the subscriber is up to date
+ */
+bool MembershipEventLog::poll(int subscriber, MembershipEvent *event) {
+	long next = cursors[subscriber];
+
+	if (next > epoch) {
+		return false;
+	}
+	*event = events[next - events.front().epoch];
+	cursors[subscriber]++;
+	trim();
+	return true;
+}
+
+/**
+ * FUNCTION NAME: skip
+ *
+ * DESCRIPTION: Mark every published event as read by a subscriber, used after it
+ * 				rebuilt its state from a full snapshot of the membership list
+ */
+void MembershipEventLog::skip(int subscriber) {
+	cursors[subscriber] = epoch + 1;
+	trim();
+}
+
+/**
+ * FUNCTION NAME: trim
+ *
+ * DESCRIPTION: Drop the events every subscriber has read
+ */
+void MembershipEventLog::trim() {
+	long oldest = *min_element(cursors.begin(), cursors.end());
+
+	while (!events.empty() && events.front().epoch < oldest) {
+		events.pop_front();
+	}
+}
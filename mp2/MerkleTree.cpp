@@ -0,0 +1,114 @@
+/**********************************
+ * FILE NAME: MerkleTree.cpp
+ *
+ * DESCRIPTION: Definition of the Merkle tree over one token range of the ring
+ **********************************/
+
+#include "MerkleTree.h"
+
+/**
+ * Constructor
+ */
+MerkleTree::MerkleTree(uint64_t from, uint64_t to) {
+	uint64_t leaves = 1ULL << MERKLE_DEPTH;
+	// from == to is the whole ring, 2^64 positions
+	uint64_t span = to - from;
+
+	this->from = from;
+	this->to = to;
+	this->leafSpan = span == 0 ? (UINT64_MAX / leaves) + 1 : span / leaves + 1;
+	nodes.assign(2 * leaves, 0);
+	// inner nodes are computed from the leaves on first read, so equal contents give equal
+	// trees whatever the history of adds and removes
+	dirty.assign(leaves, true);
+}
+
+/**
+ * FUNCTION NAME: covers
+ *
+ * DESCRIPTION: Whether a ring position falls in (from, to]
+ */
+bool MerkleTree::covers(uint64_t position) const {
+	return from == to || position - from - 1 < to - from;
+}
+
+/**
+ * FUNCTION NAME: leafOf
+ *
+ * DESCRIPTION: Array index of the leaf a ring position of the range falls in
+ */
+int MerkleTree::leafOf(uint64_t position) const {
+	return (1 << MERKLE_DEPTH) + (int) ((position - from - 1) / leafSpan);
+}
+
+/**
+ * FUNCTION NAME: leafRange
+ *
+ * DESCRIPTION: Ring range (lo, hi] of the leaf at index. The last leaves of a range shorter
+ * 				than the number of leaves are empty.
+ *
+ * RETURNS:
+ * false if the leaf covers no position
+ */
+bool MerkleTree::leafRange(int index, uint64_t *lo, uint64_t *hi) const {
+	uint64_t span = to - from;
+	uint64_t start = (uint64_t) (index - (1 << MERKLE_DEPTH)) * leafSpan;
+	// on the whole ring the end of the last leaf wraps to 0, that is to from itself
+	uint64_t end = start + leafSpan;
+
+	if (span != 0) {
+		start = min(start, span);
+		end = min(end, span);
+	}
+	*lo = from + start;
+	*hi = from + end;
+	return start != end;
+}
+
+/**
+ * FUNCTION NAME: toggle
+ *
+ * DESCRIPTION: XOR an item hash into its leaf and mark the inner nodes above it stale
+ */
+void MerkleTree::toggle(uint64_t position, uint64_t itemHash) {
+	int index = leafOf(position);
+
+	nodes[index] ^= itemHash;
+	for (index /= 2; index >= 1 && !dirty[index]; index /= 2) {
+		dirty[index] = true;
+	}
+}
+
+/**
+ * FUNCTION NAME: add
+ *
+ * DESCRIPTION: Account for an item at the given ring position
+ */
+void MerkleTree::add(uint64_t position, uint64_t itemHash) {
+	toggle(position, itemHash);
+}
+
+/**
+ * FUNCTION NAME: remove
+ *
+ * DESCRIPTION: Take back an item added earlier. XOR is its own inverse.
+ */
+void MerkleTree::remove(uint64_t position, uint64_t itemHash) {
+	toggle(position, itemHash);
+}
+
+/**
+ * FUNCTION NAME: hashAt
+ *
+ * DESCRIPTION: Hash of the node at index, recomputing the stale nodes below it
+ */
+uint64_t MerkleTree::hashAt(int index) {
+	if (!isLeaf(index) && dirty[index]) {
+		uint64_t children[2];
+		children[0] = hashAt(2 * index);
+		children[1] = hashAt(2 * index + 1);
+		nodes[index] = Hash64::hash(children, sizeof(children));
+		dirty[index] = false;
+	}
+	return nodes[index];
+}
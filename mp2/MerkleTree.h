@@ -0,0 +1,57 @@
+/**********************************
+ * FILE NAME: MerkleTree.h
+ *
+ * DESCRIPTION: Header file of the Merkle tree over one token range of the ring
+ **********************************/
+
+#ifndef MERKLETREE_H_
+#define MERKLETREE_H_
+
+#include "stdincludes.h"
+#include "Hash64.h"
+
+/**
+ * Macros
+ */
+// levels below the root, the tree has 1 << MERKLE_DEPTH leaves
+#define MERKLE_DEPTH 6
+
+/**
+ * CLASS NAME: MerkleTree
+ *
+ * DESCRIPTION: Complete binary tree over the ring range (from, to], stored as an array with the
+ * 				root at 1 and the children of i at 2i and 2i + 1. The range is cut into equal
+ * 				leaves, and a leaf is the XOR of the hashes of its items, so an item is added or
+ * 				removed in O(1). Inner nodes hash their two children and are only recomputed,
+ * 				on demand, along the paths of the leaves changed since they were last read.
+ */
+class MerkleTree {
+private:
+	uint64_t from;
+	uint64_t to;
+	uint64_t leafSpan;
+	vector<uint64_t> nodes;
+	vector<bool> dirty;
+
+	void toggle(uint64_t position, uint64_t itemHash);
+
+public:
+	MerkleTree(uint64_t from, uint64_t to);
+	uint64_t getFrom() const {
+		return from;
+	}
+	uint64_t getTo() const {
+		return to;
+	}
+	bool covers(uint64_t position) const;
+	int leafOf(uint64_t position) const;
+	bool leafRange(int index, uint64_t *lo, uint64_t *hi) const;
+	bool isLeaf(int index) const {
+		return index >= (1 << MERKLE_DEPTH);
+	}
+	void add(uint64_t position, uint64_t itemHash);
+	void remove(uint64_t position, uint64_t itemHash);
+	uint64_t hashAt(int index);
+};
+
+#endif /* MERKLETREE_H_ */
@@ -8,12 +8,15 @@
 /**
  * Constructor
  */
-// transID::fromAddr::CREATE::key::value::ReplicaType
+// transID::fromAddr::CREATE::key::value::ReplicaType[::hint]
 // transID::fromAddr::READ::key
-// transID::fromAddr::UPDATE::key::value::ReplicaType
+// transID::fromAddr::UPDATE::key::value::ReplicaType[::hint]
 // transID::fromAddr::DELETE::key
-// transID::fromAddr::REPLY::sucess
-// transID::fromAddr::READREPLY::value
+// transID::fromAddr::REPLY::sucess::value
+// transID::fromAddr::READREPLY::key::value
+// transID::fromAddr::MERKLE::range::hashes
+// transID::fromAddr::MERKLELEAF::range::items
+// transID::fromAddr::BATCH::frames
 Message::Message(string message){
 	this->delimiter = "::";
 	vector<string> tuple;
@@ -38,6 +41,8 @@ Message::Message(string message){
 			value = tuple.at(4);
 			if (tuple.size() > 5)
 				replica = static_cast<ReplicaType>(stoi(tuple.at(5)));
+			if (tuple.size() > 6)
+				hint = tuple.at(6);
 			break;
 		case READ:
 		case DELETE:
@@ -48,10 +53,24 @@ Message::Message(string message){
 				success = true;
 			else
 				success = false;
+			if (tuple.size() > 4)
+				value = tuple.at(4);
 			break;
 		case READREPLY:
-			value = tuple.at(3);
+		case MERKLE:
+		case MERKLELEAF:
+			key = tuple.at(3);
+			value = tuple.at(4);
+			break;
+		case BATCH: {
+			// the frames contain the delimiter, the value is everything after the type
+			size_t body = 0;
+			for (int i = 0; i < 3; i++) {
+				body = message.find(delimiter, body) + delimiter.size();
+			}
+			value = message.substr(body);
 			break;
+		}
 	}
 }
 
@@ -81,6 +100,7 @@ Message::Message(const Message& anotherMessage) {
 	this->transID = anotherMessage.transID;
 	this->type = anotherMessage.type;
 	this->value = anotherMessage.value;
+	this->hint = anotherMessage.hint;
 }
 
 /**
@@ -142,6 +162,8 @@ string Message::toString(){
 		case CREATE:
 		case UPDATE:
 			message += key + delimiter + value + delimiter + to_string(replica);
+			if (!hint.empty())
+				message += delimiter + hint;
 			break;
 		case READ:
 		case DELETE:
@@ -152,14 +174,49 @@ string Message::toString(){
 				message += "1";
 			else
 				message += "0";
+			message += delimiter + value;
 			break;
 		case READREPLY:
+		case MERKLE:
+		case MERKLELEAF:
+			message += key + delimiter + value;
+			break;
+		case BATCH:
 			message += value;
 			break;
 	}
 	return message;
 }
 
+/**
+ * FUNCTION NAME: appendFrame
+ *
+ * DESCRIPTION: Append a serialized message to the value of a batch, as length#message
+ */
+void Message::appendFrame(string &batch, string frame) {
+	batch += to_string(frame.size()) + "#" + frame;
+}
+
+/**
+ * FUNCTION NAME: splitFrames
+ *
+ * DESCRIPTION: Split the value of a batch back into serialized messages
+ */
+void Message::splitFrames(string &batch, vector<string> &frames) {
+	size_t pos = 0;
+
+	frames.clear();
+	while (pos < batch.size()) {
+		size_t mark = batch.find('#', pos);
+		if (mark == string::npos) {
+			break;
+		}
+		size_t length = stoul(batch.substr(pos, mark - pos));
+		frames.push_back(batch.substr(mark + 1, length));
+		pos = mark + 1 + length;
+	}
+}
+
 /**
  * Assignment operator overloading
  */
@@ -172,5 +229,6 @@ Message& Message::operator =(const Message& anotherMessage) {
 	this->transID = anotherMessage.transID;
 	this->type = anotherMessage.type;
 	this->value = anotherMessage.value;
+	this->hint = anotherMessage.hint;
 	return *this;
 }
@@ -24,6 +24,8 @@ public:
 	Address fromAddr;
 	int transID;
 	bool success; // success or not 
+	// address of the replica a write is meant for, when it was sent to a fallback node instead
+	string hint;
 	// delimiter
 	string delimiter;
 	// construct a message from a string
@@ -41,6 +43,9 @@ public:
 	Message& operator = (const Message& anotherMessage);
 	// serialize to a string
 	string toString();
+	// frames of a batch, each a serialized message
+	static void appendFrame(string &batch, string frame);
+	static void splitFrames(string &batch, vector<string> &frames);
 };
 
 #endif
@@ -19,6 +19,14 @@ Node::Node(Address address) {
 	computeHashCode();
 }
 
+/**
+ * constructor of the given ring token of a node. Token 0 hashes like Node(address).
+ */
+Node::Node(Address address, int token) {
+	this->nodeAddress = address;
+	nodeHashCode = Hash64::hash(nodeAddress.addr, sizeof(nodeAddress.addr), (uint64_t) token);
+}
+
 /**
  * Destructor
  */
@@ -27,10 +35,11 @@ Node::~Node() {}
 /**
  * FUNCTION NAME: computeHashCode
  *
- * DESCRIPTION: This function computes the hash code of the node address
+ * DESCRIPTION: This function computes the hash code of the node address, over all of its
+ * 				bytes. The address holds zero bytes, so it must not be hashed as a C string.
  */
 void Node::computeHashCode() {
-	nodeHashCode = hashFunc(nodeAddress.addr)%RING_SIZE;
+	nodeHashCode = Hash64::hash(nodeAddress.addr, sizeof(nodeAddress.addr));
 }
 
 /**
@@ -62,7 +71,7 @@ bool Node::operator < (const Node& another) const {
  *
  * DESCRIPTION: return hash code of the node
  */
-size_t Node::getHashCode() {
+uint64_t Node::getHashCode() {
 	return nodeHashCode;
 }
 
@@ -80,7 +89,7 @@ Address * Node::getAddress() {
  *
  * DESCRIPTION: set the hash code of the node
  */
-void Node::setHashCode(size_t hashCode) {
+void Node::setHashCode(uint64_t hashCode) {
 	this->nodeHashCode = hashCode;
 }
 
@@ -5,6 +5,7 @@
  **********************************/
 
 #include "Params.h"
+#include "PhiAccrualDetector.h"
 
 /**
  * Constructor
@@ -19,8 +20,26 @@ Params::Params(): PORTNUM(8001) {}
 void Params::setparams(char *config_file) {
 	//trace.funcEntry("Params::setparams");
 	char CRUD[10];
+	char FD[40] = "TIMEOUT";
+	char GS[40] = "PUSH";
+	char VW[40] = "FULL";
+	char TS[40] = "DEFAULT";
+	char DS[40] = "FULL";
+	char WS[40] = "1";
+	char key[40];
+	char value[40];
 	FILE *fp = fopen(config_file,"r");
 
+	PHI_THRESHOLD = PHI_DEFAULT_THRESHOLD;
+	INTRODUCERS = 1;
+	ZONES = 1;
+	CROSS_ZONE_DELAY = 0;
+	VNODES = 1;
+	REPLICAS = 3;
+	READ_QUORUM = 0;
+	WRITE_QUORUM = 0;
+	BATCH = 0;
+
     if (!fp) {
         MAX_NNB = 10;
         this->CRUDTEST = READ_TEST;
@@ -30,8 +49,101 @@ void Params::setparams(char *config_file) {
         fscanf(fp,"\nDROP_MSG: %d", &DROP_MSG);
         fscanf(fp,"\nMSG_DROP_PROB: %lf", &MSG_DROP_PROB);
         fscanf(fp,"\nCRUD_TEST: %s", CRUD);
+        // optional, one "KEY: value" per line in any order
+        while (fscanf(fp, " %39[^:]: %39s", key, value) == 2) {
+            if ( 0 == strcmp(key, "FAILURE_DETECTOR") ) {
+                snprintf(FD, sizeof(FD), "%s", value);
+            }
+            else if ( 0 == strcmp(key, "PHI_THRESHOLD") ) {
+                PHI_THRESHOLD = atof(value);
+            }
+            else if ( 0 == strcmp(key, "INTRODUCERS") ) {
+                INTRODUCERS = atoi(value);
+            }
+            else if ( 0 == strcmp(key, "GOSSIP") ) {
+                snprintf(GS, sizeof(GS), "%s", value);
+            }
+            else if ( 0 == strcmp(key, "VIEW") ) {
+                snprintf(VW, sizeof(VW), "%s", value);
+            }
+            else if ( 0 == strcmp(key, "ZONES") ) {
+                ZONES = atoi(value);
+            }
+            else if ( 0 == strcmp(key, "CROSS_ZONE_DELAY") ) {
+                CROSS_ZONE_DELAY = atoi(value);
+            }
+            else if ( 0 == strcmp(key, "TARGETS") ) {
+                snprintf(TS, sizeof(TS), "%s", value);
+            }
+            else if ( 0 == strcmp(key, "DISSEMINATION") ) {
+                snprintf(DS, sizeof(DS), "%s", value);
+            }
+            else if ( 0 == strcmp(key, "VNODES") ) {
+                VNODES = atoi(value);
+            }
+            else if ( 0 == strcmp(key, "WEIGHTS") ) {
+                snprintf(WS, sizeof(WS), "%s", value);
+            }
+            else if ( 0 == strcmp(key, "REPLICAS") ) {
+                REPLICAS = atoi(value);
+            }
+            else if ( 0 == strcmp(key, "READ_QUORUM") ) {
+                READ_QUORUM = atoi(value);
+            }
+            else if ( 0 == strcmp(key, "WRITE_QUORUM") ) {
+                WRITE_QUORUM = atoi(value);
+            }
+            else if ( 0 == strcmp(key, "BATCH") ) {
+                BATCH = atoi(value);
+            }
+        }
     }
 
+	if ( 0 == strcmp(FD, "PHI") ) {
+		this->FAILURE_DETECTOR = PHI_ACCRUAL_FD;
+	}
+	else {
+		this->FAILURE_DETECTOR = TIMEOUT_FD;
+	}
+
+	if ( 0 == strcmp(GS, "PUSHPULL") ) {
+		this->GOSSIP = PUSHPULL_GOSSIP;
+	}
+	else {
+		this->GOSSIP = PUSH_GOSSIP;
+	}
+
+	// the ring is built from the membership list, a partial view would give each node a ring of its own
+	if ( 0 == strcmp(VW, "PARTIAL") ) {
+		cout<<"VIEW: PARTIAL is not supported by the key-value store. Exiting!!!"<<endl;
+		exit(1);
+	}
+	this->VIEW = FULL_VIEW;
+
+	if ( 0 == strcmp(TS, "HALF") ) {
+		this->TARGETS = HALF_WINDOW_PEERS;
+	}
+	else if ( 0 == strcmp(TS, "RANDOM") ) {
+		this->TARGETS = RANDOM_PEERS;
+	}
+	else if ( 0 == strcmp(TS, "ZONE") ) {
+		this->TARGETS = ZONE_PEERS;
+	}
+	else {
+		// left out, zone-aware targets are the default once zones are configured
+		this->TARGETS = ZONES > 1 ? ZONE_PEERS : HALF_WINDOW_PEERS;
+	}
+
+	if ( 0 == strcmp(DS, "DELTA") ) {
+		this->DISSEMINATION = DELTA_LIST;
+	}
+	else if ( 0 == strcmp(DS, "PIGGYBACK") ) {
+		this->DISSEMINATION = PIGGYBACK_LIST;
+	}
+	else {
+		this->DISSEMINATION = FULL_LIST;
+	}
+
 	if ( 0 == strcmp(CRUD, "CREATE") ) {
 		this->CRUDTEST = CREATE_TEST;
 	}
@@ -48,6 +160,21 @@ void Params::setparams(char *config_file) {
 	//printf("Parameters of the test case: %d %d %d %lf\n", MAX_NNB, SINGLE_FAILURE, DROP_MSG, MSG_DROP_PROB);
 
 	EN_GPSZ = MAX_NNB;
+	INTRODUCERS = max(1, min(INTRODUCERS, EN_GPSZ));
+	ZONES = max(1, min(ZONES, EN_GPSZ));
+	CROSS_ZONE_DELAY = max(0, CROSS_ZONE_DELAY);
+	VNODES = max(1, VNODES);
+	WEIGHTS.clear();
+	for ( char *w = strtok(WS, ","); w != NULL; w = strtok(NULL, ",") ) {
+		WEIGHTS.push_back(max(1, atoi(w)));
+	}
+	if ( WEIGHTS.empty() ) {
+		WEIGHTS.push_back(1);
+	}
+	// a quorum left out is a majority of the replicas
+	REPLICAS = max(1, min(REPLICAS, EN_GPSZ));
+	READ_QUORUM = READ_QUORUM > 0 ? min(READ_QUORUM, REPLICAS) : REPLICAS / 2 + 1;
+	WRITE_QUORUM = WRITE_QUORUM > 0 ? min(WRITE_QUORUM, REPLICAS) : REPLICAS / 2 + 1;
 	STEP_RATE=.25;
 	MAX_MSG_SIZE = 4000;
 	globaltime = 0;
@@ -70,3 +197,23 @@ void Params::setparams(char *config_file) {
 int Params::getcurrtime(){
     return globaltime;
 }
+
+/**
+ * FUNCTION NAME: zoneOf
+ *
+ * DESCRIPTION: Zone of the node with the given id. The ids are split into ZONES contiguous
+ * 				blocks of equal size, the way consecutive hosts share a rack.
+ */
+int Params::zoneOf(int id){
+    return min(max(id - 1, 0) * ZONES / max(EN_GPSZ, 1), ZONES - 1);
+}
+
+/**
+ * FUNCTION NAME: tokensOf
+ *
+ * DESCRIPTION: Number of ring tokens of the node with the given id: VNODES scaled by its
+ * 				capacity weight. WEIGHTS is cycled over the ids, so "1,2" doubles every other node.
+ */
+int Params::tokensOf(int id){
+    return VNODES * WEIGHTS[max(id - 1, 0) % WEIGHTS.size()];
+}
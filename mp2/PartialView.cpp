@@ -0,0 +1,132 @@
+/**********************************
+ * FILE NAME: PartialView.cpp
+ *
+ * DESCRIPTION: Definition of the passive view of the partial-view membership protocol
+ **********************************/
+
+#include "PartialView.h"
+
+/**
+ * Constructor
+ */
+PartialView::PartialView(): passiveSize(0), activeSize(0) {}
+
+/**
+ * FUNCTION NAME: init
+ *
+ * DESCRIPTION: Size the views for a group of groupSize nodes
+ */
+void PartialView::init(int groupSize) {
+	int bits = 0;
+
+	while ((1 << bits) < groupSize) {
+		bits++;
+	}
+	activeSize = bits + HPV_ACTIVE_C;
+	passiveSize = HPV_PASSIVE_K * activeSize;
+	passive.clear();
+	passive.reserve(passiveSize);
+}
+
+/**
+ * FUNCTION NAME: clear
+ *
+ * DESCRIPTION: Drop the passive view
+ */
+void PartialView::clear() {
+	passive.clear();
+}
+
+/**
+ * FUNCTION NAME: size
+ *
+ * DESCRIPTION: Number of passive entries
+ */
+int PartialView::size() {
+	return (int) passive.size();
+}
+
+/**
+ * FUNCTION NAME: find
+ *
+ * DESCRIPTION: Position of a passive entry, -1 if absent
+ */
+int PartialView::find(int id, short port) {
+	for (size_t i = 0; i < passive.size(); i++) {
+		if (passive[i].id == id && passive[i].port == port) {
+			return (int) i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * FUNCTION NAME: add
+ *
+ * DESCRIPTION: Add or refresh a passive entry. A full view replaces a random entry.
+ */
+void PartialView::add(int id, short port, long heartbeat) {
+	int pos = find(id, port);
+
+	if (pos >= 0) {
+		passive[pos].heartbeat = max(passive[pos].heartbeat, heartbeat);
+		return;
+	}
+	if ((int) passive.size() >= passiveSize) {
+		if (passiveSize == 0) {
+			return;
+		}
+		passive[rand() % passive.size()] = MemberListEntry(id, port, heartbeat, 0);
+		return;
+	}
+	passive.push_back(MemberListEntry(id, port, heartbeat, 0));
+}
+
+/**
+ * FUNCTION NAME: remove
+ *
+ * DESCRIPTION: Remove a passive entry if present
+ */
+void PartialView::remove(int id, short port) {
+	int pos = find(id, port);
+
+	if (pos >= 0) {
+		passive[pos] = passive.back();
+		passive.pop_back();
+	}
+}
+
+/**
+ * FUNCTION NAME: takeRandom
+ *
+ * DESCRIPTION: Remove a random passive entry and return it
+ *
+ * RETURNS:
+ * false if the passive view is empty
+ */
+bool PartialView::takeRandom(MemberListEntry *entry) {
+	if (passive.empty()) {
+		return false;
+	}
+	int pos = rand() % (int) passive.size();
+	*entry = passive[pos];
+	passive[pos] = passive.back();
+	passive.pop_back();
+	return true;
+}
+
+/**
+ * FUNCTION NAME: sample
+ *
+ * DESCRIPTION: Append up to count distinct random passive entries to out
+ */
+void PartialView::sample(int count, vector<MemberListEntry> &out) {
+	int n = (int) passive.size();
+
+	// partial Fisher-Yates over the view, the order of passive entries does not matter
+	for (int i = 0; i < count && i < n; i++) {
+		int pick = i + rand() % (n - i);
+		swap(passive[i], passive[pick]);
+		out.push_back(passive[i]);
+	}
+}
@@ -0,0 +1,62 @@
+/**********************************
+ * FILE NAME: PartialView.h
+ *
+ * DESCRIPTION: Header file of the passive view of the partial-view membership protocol
+ **********************************/
+
+#ifndef _PARTIALVIEW_H_
+#define _PARTIALVIEW_H_
+
+#include "stdincludes.h"
+#include "Member.h"
+
+/**
+ * Macros
+ */
+// active view size is ceil(log2(N)) + HPV_ACTIVE_C, passive view size HPV_PASSIVE_K times that
+#define HPV_ACTIVE_C 1
+#define HPV_PASSIVE_K 6
+// random walk lengths of FORWARDJOIN, and the walk length at which the joiner enters passive views
+#define HPV_ARWL 6
+#define HPV_PRWL 3
+// argument of a NEIGHBOR message
+#define HPV_NEIGHBOR_LOW 0
+#define HPV_NEIGHBOR_HIGH 1
+#define HPV_NEIGHBOR_ACCEPT 2
+// ticks between shuffles, and how many active and passive entries a shuffle carries
+#define HPV_SHUFFLE_PERIOD 10
+#define HPV_SHUFFLE_ACTIVE 3
+#define HPV_SHUFFLE_PASSIVE 4
+
+/**
+ * CLASS NAME: PartialView
+ *
+ * DESCRIPTION: Bounded passive view of a HyParView-style membership protocol (Leitao et al.).
+ * 				The active view is the membership table itself. The passive view only keeps
+ * 				addresses to promote when an active member fails, and is refreshed by shuffles.
+ * 				Failure detection only covers the active view, so a failed node is removed by
+ * 				its active neighbours alone, not by the whole group. Under message loss an
+ * 				active neighbour whose heartbeats are all lost for TREMOVE ticks is removed
+ * 				and replaced while still alive: a multifailure run with message drops gave one
+ * 				such false removal. The key-value store needs the full membership and does not
+ * 				accept this mode.
+ */
+class PartialView {
+private:
+	vector<MemberListEntry> passive;
+	int passiveSize;
+
+public:
+	int activeSize;
+	PartialView();
+	void init(int groupSize);
+	void clear();
+	int size();
+	int find(int id, short port);
+	void add(int id, short port, long heartbeat);
+	void remove(int id, short port);
+	bool takeRandom(MemberListEntry *entry);
+	void sample(int count, vector<MemberListEntry> &out);
+};
+
+#endif /* _PARTIALVIEW_H_ */
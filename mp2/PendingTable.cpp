@@ -0,0 +1,87 @@
+/**********************************
+ * FILE NAME: PendingTable.cpp
+ *
+ * DESCRIPTION: Definition of the coordinator's table of pending client requests
+ **********************************/
+
+#include "PendingTable.h"
+
+/**
+ * Constructor
+ */
+PendingTable::PendingTable() {
+	freeList = TW_NONE;
+}
+
+/**
+ * FUNCTION NAME: open
+ *
+ * DESCRIPTION: Start tracking a request that expires at deadline, in a free slot if there is one
+ *
+ * RETURNS:
+ * the new entry, valid until it is closed or the table grows
+ */
+PendingRequest *PendingTable::open(int transID, MessageType type, string key, long deadline) {
+	int slot;
+
+	if (freeList != TW_NONE) {
+		slot = freeList;
+		freeList = slots[slot].next;
+	} else {
+		slot = (int) slots.size();
+		slots.push_back(PendingRequest());
+	}
+	PendingRequest *request = &slots[slot];
+	request->transID = transID;
+	request->type = type;
+	request->key = key;
+	request->value.clear();
+	request->quorum = 0;
+	request->replicas = 0;
+	request->successes = 0;
+	request->failures = 0;
+	request->decided = false;
+	// clear() keeps the capacity of the reused slot
+	request->versions.clear();
+	request->timer = wheel.add(deadline, slot);
+	request->next = TW_NONE;
+	index[transID] = slot;
+	return request;
+}
+
+/**
+ * FUNCTION NAME: find
+ *
+ * DESCRIPTION: Look up a request by transaction id
+ *
+ * RETURNS:
+ * the entry, NULL if the request is not pending
+ */
+PendingRequest *PendingTable::find(int transID) {
+	map<int, int>::iterator it = index.find(transID);
+	return it == index.end() ? NULL : &slots[it->second];
+}
+
+/**
+ * FUNCTION NAME: close
+ *
+ * DESCRIPTION: Stop tracking a request and return its slot to the free list
+ */
+void PendingTable::close(PendingRequest *request) {
+	int slot = (int) (request - &slots[0]);
+
+	wheel.cancel(request->timer);
+	index.erase(request->transID);
+	request->next = freeList;
+	freeList = slot;
+}
+
+/**
+ * FUNCTION NAME: expire
+ *
+ * DESCRIPTION: Call expire(env, timer, slot) for every request whose deadline is now or
+ * 				earlier. The callback is expected to close the request.
+ */
+void PendingTable::expire(long now, void (* expire)(void *, int, int), void *env) {
+	wheel.advance(now, expire, env);
+}
@@ -0,0 +1,74 @@
+/**********************************
+ * FILE NAME: PendingTable.h
+ *
+ * DESCRIPTION: Header file of the coordinator's table of pending client requests
+ **********************************/
+
+#ifndef PENDINGTABLE_H_
+#define PENDINGTABLE_H_
+
+#include "stdincludes.h"
+#include "common.h"
+#include "Member.h"
+#include "TimerWheel.h"
+
+/**
+ * Macros
+ */
+// ticks a request waits for its quorum, and a read for the replies it repairs from
+#define PENDING_TIMEOUT 10
+
+/**
+ * STRUCT NAME: PendingRequest
+ *
+ * DESCRIPTION: Coordinator state of one client request
+ */
+typedef struct PendingRequest {
+	int transID;
+	MessageType type;
+	string key;
+	// entry sent to the replicas, as logged by the coordinator
+	string value;
+	// successful replies needed, and replicas the request went to
+	int quorum;
+	int replicas;
+	int successes;
+	int failures;
+	bool decided;
+	// copies returned by the replicas of a read, for read repair
+	vector<pair<Address, string> > versions;
+	int timer;
+	// next free slot while the slot is unused
+	int next;
+}PendingRequest;
+
+/**
+ * CLASS NAME: PendingTable
+ *
+ * DESCRIPTION: Requests a node coordinates, keyed by transaction id. Entries live in a slab
+ * 				of reused slots, so a request allocates nothing once the slab has grown to the
+ * 				node's peak load, and are freed as soon as the request is over. Every entry has
+ * 				a deadline in a timer wheel, so a tick only touches the requests that expire.
+ */
+class PendingTable {
+private:
+	vector<PendingRequest> slots;
+	int freeList;
+	map<int, int> index;
+	TimerWheel wheel;
+
+public:
+	PendingTable();
+	PendingRequest *open(int transID, MessageType type, string key, long deadline);
+	PendingRequest *find(int transID);
+	PendingRequest *at(int slot) {
+		return &slots[slot];
+	}
+	void close(PendingRequest *request);
+	void expire(long now, void (* expire)(void *, int, int), void *env);
+	size_t size() const {
+		return index.size();
+	}
+};
+
+#endif /* PENDINGTABLE_H_ */
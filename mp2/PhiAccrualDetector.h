@@ -0,0 +1,63 @@
+/**********************************
+ * FILE NAME: PhiAccrualDetector.h
+ *
+ * DESCRIPTION: Header file of the phi-accrual failure detector
+ **********************************/
+
+#ifndef _PHIACCRUALDETECTOR_H_
+#define _PHIACCRUALDETECTOR_H_
+
+#include "stdincludes.h"
+
+/**
+ * Macros
+ */
+// number of inter-arrival samples kept per member
+#define PHI_WINDOW 16
+// samples needed before phi is trusted, until then the fixed timeout applies
+#define PHI_MIN_SAMPLES 4
+// floor on the standard deviation, in ticks, so a perfectly regular member is not suspected after one late tick
+#define PHI_MIN_STDDEV 0.5
+#define PHI_DEFAULT_THRESHOLD 8.0
+
+/**
+ * STRUCT NAME: ArrivalWindow
+ *
+ * DESCRIPTION: Ring buffer of the last inter-arrival times of one member's heartbeat, in ticks.
+ * 				Running sums keep the mean and variance O(1) to update.
+ */
+typedef struct ArrivalWindow {
+	unsigned char intervals[PHI_WINDOW];
+	unsigned char head;
+	unsigned char count;
+	int sum;
+	int sumSquares;
+	long lastArrival;
+}ArrivalWindow;
+
+/**
+ * CLASS NAME: PhiAccrualDetector
+ *
+ * DESCRIPTION: Phi-accrual failure detector (Hayashibara et al.) over a normal model of the
+ * 				inter-arrival times. A member is suspected once phi, the -log10 probability that a
+ * 				heartbeat is still to come, passes the threshold.
+ */
+class PhiAccrualDetector {
+private:
+	double threshold;
+	// standard score at which phi reaches the threshold
+	double zThreshold;
+
+public:
+	PhiAccrualDetector(double threshold = PHI_DEFAULT_THRESHOLD);
+	void setThreshold(double threshold);
+	static void reset(ArrivalWindow *window, long now);
+	static void heartbeat(ArrivalWindow *window, long now);
+	static double mean(ArrivalWindow *window);
+	static double stddev(ArrivalWindow *window);
+	static double phiOf(double z);
+	double phi(ArrivalWindow *window, long now);
+	long suspectDeadline(ArrivalWindow *window, long fallback);
+};
+
+#endif /* _PHIACCRUALDETECTOR_H_ */
@@ -0,0 +1,165 @@
+/**********************************
+ * FILE NAME: Ring.cpp
+ *
+ * DESCRIPTION: Definition of the consistent hashing ring
+ **********************************/
+
+#include "Ring.h"
+
+/**
+ * Constructor
+ */
+Ring::Ring(int replicas, Params *par) {
+	this->replicas = replicas;
+	this->par = par;
+	this->epoch = 0;
+}
+
+/**
+ * FUNCTION NAME: assign
+ *
+ * DESCRIPTION: Replace the ring with the tokens of the given members, sorted once by hash code
+ */
+void Ring::assign(vector<Node> &members) {
+	nodes.clear();
+	for (size_t i = 0; i < members.size(); i++) {
+		int tokens = par->tokensOf(*(int *) members[i].getAddress()->addr);
+		for (int t = 0; t < tokens; t++) {
+			nodes.push_back(Node(*members[i].getAddress(), t));
+		}
+	}
+	sort(nodes.begin(), nodes.end());
+	epoch++;
+}
+
+/**
+ * FUNCTION NAME: find
+ *
+ * DESCRIPTION: Look up a node by binary search on its hash code, then by address among the
+ * 				nodes sharing that hash code
+ *
+ * RETURNS:
+ * position of the node, -1 if it is not on the ring
+ */
+int Ring::find(Node &node) {
+	vector<Node>::iterator it = lower_bound(nodes.begin(), nodes.end(), node);
+
+	for (; it != nodes.end() && it->getHashCode() == node.getHashCode(); it++) {
+		if (memcmp(it->getAddress()->addr, node.getAddress()->addr, sizeof(node.getAddress()->addr)) == 0) {
+			return (int) (it - nodes.begin());
+		}
+	}
+	return -1;
+}
+
+/**
+ * FUNCTION NAME: insert
+ *
+ * DESCRIPTION: Insert the tokens of a node at their places on the ring
+ *
+ * RETURNS:
+ * true if the node was not on the ring yet
+ */
+bool Ring::insert(Node &node) {
+	int tokens = par->tokensOf(*(int *) node.getAddress()->addr);
+	bool changed = false;
+
+	for (int t = 0; t < tokens; t++) {
+		Node token = Node(*node.getAddress(), t);
+		if (find(token) < 0) {
+			nodes.insert(upper_bound(nodes.begin(), nodes.end(), token), token);
+			changed = true;
+		}
+	}
+	if (changed) {
+		epoch++;
+	}
+	return changed;
+}
+
+/**
+ * FUNCTION NAME: erase
+ *
+ * DESCRIPTION: Remove the tokens of a node from the ring
+ *
+ * RETURNS:
+ * true if the node was on the ring
+ */
+bool Ring::erase(Node &node) {
+	int tokens = par->tokensOf(*(int *) node.getAddress()->addr);
+	bool changed = false;
+
+	for (int t = 0; t < tokens; t++) {
+		Node token = Node(*node.getAddress(), t);
+		int pos = find(token);
+		if (pos >= 0) {
+			nodes.erase(nodes.begin() + pos);
+			changed = true;
+		}
+	}
+	if (changed) {
+		epoch++;
+	}
+	return changed;
+}
+
+/**
+ * FUNCTION NAME: owner
+ *
+ * DESCRIPTION: First node clockwise from hashCode, wrapping around past the largest hash code
+ *
+ * RETURNS:
+ * position of the node, -1 if the ring is empty
+ */
+int Ring::owner(uint64_t hashCode) {
+	Node key;
+
+	if (nodes.empty()) {
+		return -1;
+	}
+	key.setHashCode(hashCode);
+	vector<Node>::iterator it = lower_bound(nodes.begin(), nodes.end(), key);
+	return it == nodes.end() ? 0 : (int) (it - nodes.begin());
+}
+
+/**
+ * FUNCTION NAME: walk
+ *
+ * DESCRIPTION: Fill out with the node at pos and the next distinct physical nodes met going
+ * 				step tokens at a time, until there are count of them or the ring has been
+ * 				walked around once
+ */
+void Ring::walk(int pos, int step, int count, vector<Node> &out) {
+	int size = (int) nodes.size();
+
+	out.clear();
+	for (int i = 0; i < size && (int) out.size() < count; i++) {
+		Node &node = nodes[((pos + i * step) % size + size) % size];
+		bool seen = false;
+		for (size_t j = 0; j < out.size() && !seen; j++) {
+			seen = memcmp(out[j].getAddress()->addr, node.getAddress()->addr, sizeof(node.getAddress()->addr)) == 0;
+		}
+		if (!seen) {
+			out.push_back(node);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: replicasAt
+ *
+ * DESCRIPTION: The node at pos and the distinct nodes following it, up to the replication
+ * 				factor. Built on first use in an epoch and reused until the ring changes.
+ */
+vector<Node> &Ring::replicasAt(int pos) {
+	if (replicaSets.size() != nodes.size()) {
+		replicaSets.resize(nodes.size());
+		replicaEpochs.assign(nodes.size(), -1);
+	}
+	vector<Node> &set = replicaSets[pos];
+	if (replicaEpochs[pos] != epoch) {
+		walk(pos, 1, replicas, set);
+		replicaEpochs[pos] = epoch;
+	}
+	return set;
+}
@@ -0,0 +1,56 @@
+/**********************************
+ * FILE NAME: Ring.h
+ *
+ * DESCRIPTION: Header file of the consistent hashing ring
+ **********************************/
+
+#ifndef RING_H_
+#define RING_H_
+
+#include "stdincludes.h"
+#include "Node.h"
+#include "Params.h"
+
+/**
+ * CLASS NAME: Ring
+ *
+ * DESCRIPTION: Tokens sorted by hash code. Each node owns Params::tokensOf(id) tokens, so
+ * 				its share of the keys follows its weight and the ranges of a failed node are
+ * 				spread over many successors. Membership changes are applied one node at a time,
+ * 				and the owner of a hash is found by binary search. The replica set of each ring
+ * 				position is built on first use and kept until the ring next changes.
+ */
+class Ring {
+private:
+	vector<Node> nodes;
+	int replicas;
+	Params *par;
+	// bumped on every change, replica sets of an older epoch are stale
+	long epoch;
+	vector<vector<Node> > replicaSets;
+	vector<long> replicaEpochs;
+
+public:
+	Ring(int replicas, Params *par);
+	void assign(vector<Node> &members);
+	bool insert(Node &node);
+	bool erase(Node &node);
+	int owner(uint64_t hashCode);
+	int find(Node &node);
+	void walk(int pos, int step, int count, vector<Node> &out);
+	vector<Node> &replicasAt(int pos);
+	Node &at(int pos) {
+		return nodes[pos];
+	}
+	size_t size() const {
+		return nodes.size();
+	}
+	bool empty() const {
+		return nodes.empty();
+	}
+	long getEpoch() const {
+		return epoch;
+	}
+};
+
+#endif /* RING_H_ */
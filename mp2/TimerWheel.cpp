@@ -0,0 +1,206 @@
+/**********************************
+ * FILE NAME: TimerWheel.cpp
+ *
+ * DESCRIPTION: Definition of the hierarchical timer wheel
+ **********************************/
+
+#include "TimerWheel.h"
+
+/**
+ * Constructor
+ */
+TimerWheel::TimerWheel() {
+	reset(0);
+}
+
+/**
+ * Destructor
+ */
+TimerWheel::~TimerWheel() {}
+
+/**
+ * FUNCTION NAME: reset
+ *
+ * DESCRIPTION: Drop all timers and restart the wheel at time now
+ */
+void TimerWheel::reset(long now) {
+	nodes.clear();
+	freeList = TW_NONE;
+	for (int level = 0; level < TW_LEVELS; level++) {
+		for (int slot = 0; slot < TW_SLOTS; slot++) {
+			heads[level][slot] = TW_NONE;
+		}
+	}
+	this->now = now;
+}
+
+/**
+ * FUNCTION NAME: place
+ *
+ * DESCRIPTION: Link a timer into the slot matching its distance from now.
+ * 				Timers further out than the top level wait in the top level and are placed again
+ * 				each time their slot cascades.
+ */
+void TimerWheel::place(int timer) {
+	TimerNode *node = &nodes[timer];
+	long delta = node->deadline - now;
+	int level = 0;
+
+	while (level < TW_LEVELS - 1 && delta >= (1L << (TW_BITS * (level + 1)))) {
+		level++;
+	}
+	node->level = level;
+	node->slot = (int) ((node->deadline >> (TW_BITS * level)) & (TW_SLOTS - 1));
+	node->prev = TW_NONE;
+	node->next = heads[level][node->slot];
+	if (node->next != TW_NONE) {
+		nodes[node->next].prev = timer;
+	}
+	heads[level][node->slot] = timer;
+}
+
+/**
+ * FUNCTION NAME: unlink
+ *
+ * DESCRIPTION: Take a timer out of its slot list, if it is in one
+ */
+void TimerWheel::unlink(int timer) {
+	TimerNode *node = &nodes[timer];
+
+	if (node->level == TW_NONE) {
+		return;
+	}
+	if (node->prev != TW_NONE) {
+		nodes[node->prev].next = node->next;
+	} else {
+		heads[node->level][node->slot] = node->next;
+	}
+	if (node->next != TW_NONE) {
+		nodes[node->next].prev = node->prev;
+	}
+	node->level = TW_NONE;
+}
+
+/**
+ * FUNCTION NAME: cascade
+ *
+ * DESCRIPTION: Move the timers of the current slot of a higher level down to where they now belong
+ */
+void TimerWheel::cascade(int level) {
+	int slot = (int) ((now >> (TW_BITS * level)) & (TW_SLOTS - 1));
+	int timer = heads[level][slot];
+
+	heads[level][slot] = TW_NONE;
+	while (timer != TW_NONE) {
+		int next = nodes[timer].next;
+		place(timer);
+		timer = next;
+	}
+}
+
+/**
+ * FUNCTION NAME: add
+ *
+ * DESCRIPTION: Start a timer. Deadlines that are not in the future fire on the next tick.
+ *
+ * RETURNS:
+ * handle of the timer
+ */
+int TimerWheel::add(long deadline, int owner) {
+	int timer;
+
+	if (freeList != TW_NONE) {
+		timer = freeList;
+		freeList = nodes[timer].next;
+	} else {
+		timer = (int) nodes.size();
+		nodes.push_back(TimerNode());
+	}
+	nodes[timer].deadline = max(deadline, now + 1);
+	nodes[timer].owner = owner;
+	place(timer);
+	return timer;
+}
+
+/**
+ * FUNCTION NAME: reschedule
+ *
+ * DESCRIPTION: Move a pending or expired timer to a new deadline
+ */
+void TimerWheel::reschedule(int timer, long deadline) {
+	unlink(timer);
+	nodes[timer].deadline = max(deadline, now + 1);
+	place(timer);
+}
+
+/**
+ * FUNCTION NAME: cancel
+ *
+ * DESCRIPTION: Stop a timer and release its handle
+ */
+void TimerWheel::cancel(int timer) {
+	unlink(timer);
+	nodes[timer].next = freeList;
+	freeList = timer;
+}
+
+/**
+ * FUNCTION NAME: setOwner
+ *
+ * DESCRIPTION: setter
+ */
+void TimerWheel::setOwner(int timer, int owner) {
+	nodes[timer].owner = owner;
+}
+
+/**
+ * FUNCTION NAME: getOwner
+ *
+ * DESCRIPTION: getter
+ */
+int TimerWheel::getOwner(int timer) {
+	return nodes[timer].owner;
+}
+
+/**
+ * FUNCTION NAME: getDeadline
+ *
+ * DESCRIPTION: getter
+ */
+long TimerWheel::getDeadline(int timer) {
+	return nodes[timer].deadline;
+}
+
+/**
+ * FUNCTION NAME: advance
+ *
+ * DESCRIPTION: Run the wheel forward to time to and call expire(env, timer, owner) for every
+ * 				timer that falls due. An expired timer keeps its handle until the callback
+ * 				reschedules or cancels it.
+ */
+void TimerWheel::advance(long to, void (* expire)(void *, int, int), void *env) {
+	while (now < to) {
+		now++;
+
+		// cascade from the highest level whose period starts now, so that timers
+		// moved down from it are cascaded again by the levels below
+		int top = 0;
+		while (top < TW_LEVELS - 1 && (now & ((1L << (TW_BITS * (top + 1))) - 1)) == 0) {
+			top++;
+		}
+		for (int level = top; level > 0; level--) {
+			cascade(level);
+		}
+
+		int slot = (int) (now & (TW_SLOTS - 1));
+		while (heads[0][slot] != TW_NONE) {
+			int timer = heads[0][slot];
+			unlink(timer);
+			if (nodes[timer].deadline > now) {
+				place(timer);
+				continue;
+			}
+			(*expire)(env, timer, nodes[timer].owner);
+		}
+	}
+}
@@ -4,12 +4,16 @@
 /**
  * Global variable
  */
-// Transaction Id
-static int g_transID = 0;
+// Transaction Id, defined in MP2Node.cpp
+extern int g_transID;
 
-// message types, reply is the message from node to coordinator
-enum MessageType {CREATE, READ, UPDATE, DELETE, REPLY, READREPLY};
-// enum of replica types
-enum ReplicaType {PRIMARY, SECONDARY, TERTIARY};
+// message types, reply is the message from node to coordinator. MERKLE and MERKLELEAF are the
+// anti-entropy exchange between replicas of a range, BATCH carries several messages to one node.
+enum MessageType {CREATE, READ, UPDATE, DELETE, REPLY, READREPLY, MERKLE, MERKLELEAF, BATCH};
+// enum of replica types, the position of a replica in the replica set. With more than three
+// replicas the later positions have no name, the underlying type keeps them valid values.
+enum ReplicaType : int {PRIMARY, SECONDARY, TERTIARY};
+// replies a client request waits for: one, the configured read or write quorum, or every replica
+enum ConsistencyLevel {ONE, QUORUM, ALL};
 
 #endif
@@ -10,7 +10,6 @@
 /*
  * Macros
  */
-#define RING_SIZE 512
 #define FAILURE -1
 #define SUCCESS 0
 
@@ -31,6 +30,7 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <set>
 #include <string>
 #include <algorithm>
 #include <queue>